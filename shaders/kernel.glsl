@@ -0,0 +1,15 @@
+// 3x3 convolution shared by the post-processing effects
+
+uniform vec2 offsets[9];
+uniform float edge_kernel[9];
+uniform float blur_kernel[9];
+
+vec3 convolve(sampler2D image, vec2 coords, float kernel[9])
+{
+    vec3 result = vec3(0.0);
+    for(int i = 0; i < 9; i++)
+    {
+        result += vec3(texture(image, coords.st + offsets[i])) * kernel[i];
+    }
+    return result;
+}
@@ -0,0 +1,22 @@
+#version 330 core
+
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D scene;
+
+#include "kernel.glsl"
+
+void main()
+{
+    // blur only the bright parts of the scene and add them back on top
+    const float threshold = 0.7;
+    const float strength = 1.5;
+    vec3 glow = vec3(0.0);
+    for(int i = 0; i < 9; i++)
+    {
+        vec3 sampled = vec3(texture(scene, TexCoords.st + offsets[i] * 2.0));
+        glow += max(sampled - threshold, 0.0) * blur_kernel[i];
+    }
+    color = vec4(texture(scene, TexCoords).rgb + glow * strength, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D scene;
+uniform vec2 resolution;
+
+void main()
+{
+    // slight barrel distortion of the screen
+    vec2 centered = TexCoords * 2.0 - 1.0;
+    centered *= 1.0 + dot(centered, centered) * 0.04;
+    vec2 coords = centered * 0.5 + 0.5;
+    if(coords.x < 0.0 || coords.x > 1.0 || coords.y < 0.0 || coords.y > 1.0)
+    {
+        color = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+    vec3 sampled = texture(scene, coords).rgb;
+    // darken every other line and fade out towards the corners
+    float scanline = 0.8 + 0.2 * sin(coords.y * resolution.y * 3.14159);
+    float vignette = 1.0 - dot(centered, centered) * 0.25;
+    color = vec4(sampled * scanline * vignette, 1.0);
+}
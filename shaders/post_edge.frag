@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D scene;
+
+#include "kernel.glsl"
+
+void main()
+{
+    color = vec4(convolve(scene, TexCoords, edge_kernel), 1.0);
+}
@@ -0,0 +1,52 @@
+#version 330 core
+
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D scene;
+uniform vec2 resolution;
+
+float luma(vec3 rgb)
+{
+    return dot(rgb, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+    // FXAA: blur along the local edge direction wherever the luma contrast is high
+    vec2 texel = 1.0 / resolution;
+    vec3 rgbNW = texture(scene, TexCoords + vec2(-1.0, -1.0) * texel).rgb;
+    vec3 rgbNE = texture(scene, TexCoords + vec2( 1.0, -1.0) * texel).rgb;
+    vec3 rgbSW = texture(scene, TexCoords + vec2(-1.0,  1.0) * texel).rgb;
+    vec3 rgbSE = texture(scene, TexCoords + vec2( 1.0,  1.0) * texel).rgb;
+    vec3 rgbM  = texture(scene, TexCoords).rgb;
+    float lumaNW = luma(rgbNW);
+    float lumaNE = luma(rgbNE);
+    float lumaSW = luma(rgbSW);
+    float lumaSE = luma(rgbSE);
+    float lumaM  = luma(rgbM);
+    float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+    // leave low contrast areas alone
+    if(lumaMax - lumaMin < max(0.0312, lumaMax * 0.125))
+    {
+        color = vec4(rgbM, 1.0);
+        return;
+    }
+
+    vec2 dir;
+    dir.x = -((lumaNW + lumaNE) - (lumaSW + lumaSE));
+    dir.y =  ((lumaNW + lumaSW) - (lumaNE + lumaSE));
+    float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 * 0.125), 1.0 / 128.0);
+    float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+    dir = clamp(dir * rcpDirMin, vec2(-8.0), vec2(8.0)) * texel;
+
+    vec3 rgbA = 0.5 * (
+        texture(scene, TexCoords + dir * (1.0 / 3.0 - 0.5)).rgb +
+        texture(scene, TexCoords + dir * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 rgbB = rgbA * 0.5 + 0.25 * (
+        texture(scene, TexCoords + dir * -0.5).rgb +
+        texture(scene, TexCoords + dir * 0.5).rgb);
+    float lumaB = luma(rgbB);
+    color = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, 1.0);
+}
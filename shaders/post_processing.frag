@@ -1,53 +1,25 @@
 #version 330 core
 
+// effects are selected at compile time through CHAOS, CONFUSE and SHAKE defines
+
 in vec2 TexCoords;
 out vec4 color;
 
 uniform sampler2D scene;
-uniform vec2 offsets[9];
-uniform int edge_kernel[9];
-uniform float blur_kernel[9];
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
+#if defined(CHAOS) || defined(SHAKE)
+#include "kernel.glsl"
+#endif
 
 void main()
 {
-    color = vec4(0.0);
-    vec3 sample[9];
-    // sample from texture offsets if using convolution matrix
-    if(chaos || shake)
-    {
-        for(int i = 0; i < 9; i++)
-        {
-            sample[i] = vec3(texture(scene, TexCoords.st + offsets[i]));
-        }
-    }
-
-    // process effects
-    if(chaos)
-    {
-        for(int i = 0; i < 9; i++)
-        {
-            color += vec4(sample[i] * edge_kernel[i], 0.0);
-        }
-        color.a = 1.0;
-    }
-    else if(confuse)
-    {
-        color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
-    }
-    else if(shake)
-    {
-        for(int i = 0; i < 9; i++)
-        {
-            color += vec4(sample[i] * blur_kernel[i], 1.0);
-        }
-        color.a = 1.0;
-    }
-    else
-    {
-        color = texture(scene, TexCoords);
-    }
-}
\ No newline at end of file
+#if defined(CHAOS)
+    color = vec4(convolve(scene, TexCoords, edge_kernel), 1.0);
+#elif defined(CONFUSE)
+    color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
+#elif defined(SHAKE)
+    color = vec4(convolve(scene, TexCoords, blur_kernel), 1.0);
+#else
+    color = texture(scene, TexCoords);
+#endif
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+layout (location = 0) in vec4 vertex;
+// per instance
+layout (location = 1) in vec4 rect; // position (xy) and size (zw)
+layout (location = 2) in vec4 color;
+layout (location = 3) in float rotation; // degrees
+
+out vec2 TexCoords;
+out vec4 SpriteColor;
+
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = vertex.zw;
+    SpriteColor = color;
+    // scale, then rotate around the quad's center, then translate
+    vec2 local = (vertex.xy - 0.5) * rect.zw;
+    float angle = radians(rotation);
+    float s = sin(angle);
+    float c = cos(angle);
+    local = vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+    gl_Position = projection * vec4(rect.xy + 0.5 * rect.zw + local, 0.0, 1.0);
+}
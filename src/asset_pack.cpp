@@ -0,0 +1,259 @@
+#include "asset_pack.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "hash.h"
+
+const char PACK_MAGIC[4] = { 'B', 'P', 'A', 'K' };
+const unsigned int PACK_VERSION = 1;
+
+MappedFile* AssetPack::pack = nullptr;
+PackHeader AssetPack::header;
+const PackEntry* AssetPack::slots = nullptr;
+
+// the files below a directory, recursively
+void listTree(const std::string& directory, std::vector<std::string>& files)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((directory + "/*").c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE)
+		return;
+	do
+	{
+		std::string name = data.cFileName;
+		if (name == "." || name == "..")
+			continue;
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			listTree(directory + "/" + name, files);
+		else
+			files.push_back(directory + "/" + name);
+	} while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	DIR* dir = opendir(directory.c_str());
+	if (!dir)
+		return;
+	while (dirent* entry = readdir(dir))
+	{
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		std::string file = directory + "/" + name;
+		struct stat info;
+		if (stat(file.c_str(), &info) != 0)
+			continue;
+		if (S_ISDIR(info.st_mode))
+			listTree(file, files);
+		else if (S_ISREG(info.st_mode))
+			files.push_back(file);
+	}
+	closedir(dir);
+#endif
+}
+
+size_t alignUp(size_t offset)
+{
+	return (offset + AssetPack::PACK_ALIGNMENT - 1) & ~static_cast<size_t>(AssetPack::PACK_ALIGNMENT - 1);
+}
+
+bool AssetPack::Open(const std::string& file)
+{
+	Close();
+	pack = new MappedFile();
+	if (!pack->Open(file))
+	{
+		std::cout << "ERROR::PACK: Failed to open " << file << std::endl;
+		Close();
+		return false;
+	}
+	// everything is checked once here, so lookups can trust the offsets
+	bool valid = pack->Size >= sizeof(PackHeader);
+	if (valid)
+	{
+		std::memcpy(&header, pack->Data, sizeof(header));
+		valid = std::memcmp(header.Magic, PACK_MAGIC, 4) == 0 && header.Version == PACK_VERSION &&
+			header.Slots != 0 && (header.Slots & (header.Slots - 1)) == 0 && header.Count < header.Slots &&
+			(pack->Size - sizeof(PackHeader)) / sizeof(PackEntry) >= header.Slots;
+	}
+	if (valid)
+	{
+		slots = reinterpret_cast<const PackEntry*>(pack->Data + sizeof(PackHeader));
+		unsigned int count = 0;
+		for (unsigned int i = 0; valid && i < header.Slots; ++i)
+		{
+			const PackEntry& entry = slots[i];
+			if (entry.PathLength == 0)
+				continue;
+			++count;
+			valid = entry.Path <= pack->Size && entry.PathLength <= pack->Size - entry.Path &&
+				entry.Offset <= pack->Size && entry.Size <= pack->Size - entry.Offset;
+		}
+		valid = valid && count == header.Count;
+	}
+	if (!valid)
+	{
+		std::cout << "ERROR::PACK: Not an asset pack (or an unsupported version): " << file << std::endl;
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void AssetPack::Close()
+{
+	delete pack;
+	pack = nullptr;
+	slots = nullptr;
+	header.Count = 0;
+}
+
+bool AssetPack::IsOpen()
+{
+	return slots != nullptr;
+}
+
+unsigned int AssetPack::Count()
+{
+	return IsOpen() ? header.Count : 0;
+}
+
+bool AssetPack::Find(const std::string& path, const unsigned char*& data, size_t& size)
+{
+	if (!slots)
+		return false;
+	std::string name = normalize(path);
+	unsigned long long hash = HashString(name);
+	unsigned int mask = header.Slots - 1;
+	// the table is never full, so a free slot ends every probe
+	for (unsigned int i = static_cast<unsigned int>(hash) & mask; slots[i].PathLength != 0; i = (i + 1) & mask)
+	{
+		const PackEntry& entry = slots[i];
+		if (entry.Hash == hash && entry.PathLength == name.size() && std::memcmp(pack->Data + entry.Path, name.data(), name.size()) == 0)
+		{
+			data = pack->Data + entry.Offset;
+			size = static_cast<size_t>(entry.Size);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool AssetPack::Build(const std::string& file, const std::vector<std::string>& directories)
+{
+	std::vector<std::string> paths;
+	for (const std::string& directory : directories)
+		listTree(normalize(directory), paths);
+	if (paths.empty())
+	{
+		std::cout << "ERROR::PACK: No assets to pack" << std::endl;
+		return false;
+	}
+	// a table at most half full keeps the probes short
+	unsigned int count = static_cast<unsigned int>(paths.size());
+	PackHeader packHeader = { { 'B', 'P', 'A', 'K' }, PACK_VERSION, count, 2 };
+	while (packHeader.Slots < count * 2)
+		packHeader.Slots *= 2;
+	std::vector<PackEntry> table(packHeader.Slots);
+	std::memset(table.data(), 0, table.size() * sizeof(PackEntry));
+
+	// layout: header, table, paths, then the aligned assets
+	size_t offset = sizeof(PackHeader) + table.size() * sizeof(PackEntry);
+	std::vector<size_t> pathOffsets;
+	for (const std::string& path : paths)
+	{
+		pathOffsets.push_back(offset);
+		offset += path.size();
+	}
+	std::vector<std::vector<unsigned char>> contents(count);
+	std::vector<size_t> assetOffsets(count);
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		std::ifstream stream(paths[i], std::ios::binary);
+		if (!stream)
+		{
+			std::cout << "ERROR::PACK: Failed to read " << paths[i] << std::endl;
+			return false;
+		}
+		contents[i].assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		PackEntry entry;
+		entry.Hash = HashString(paths[i]);
+		offset = alignUp(offset);
+		entry.Offset = assetOffsets[i] = offset;
+		entry.Size = contents[i].size();
+		entry.Path = static_cast<unsigned int>(pathOffsets[i]);
+		entry.PathLength = static_cast<unsigned int>(paths[i].size());
+		offset += contents[i].size();
+		unsigned int slot = static_cast<unsigned int>(entry.Hash) & (packHeader.Slots - 1);
+		while (table[slot].PathLength != 0)
+			slot = (slot + 1) & (packHeader.Slots - 1);
+		table[slot] = entry;
+	}
+
+	// the padding between the assets stays zero
+	std::vector<unsigned char> packed(offset, 0);
+	std::memcpy(packed.data(), &packHeader, sizeof(packHeader));
+	std::memcpy(packed.data() + sizeof(PackHeader), table.data(), table.size() * sizeof(PackEntry));
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		std::memcpy(packed.data() + pathOffsets[i], paths[i].data(), paths[i].size());
+		if (!contents[i].empty())
+			std::memcpy(packed.data() + assetOffsets[i], contents[i].data(), contents[i].size());
+	}
+	if (!WriteFileReplacing(file, packed.data(), packed.size()))
+	{
+		std::cout << "ERROR::PACK: Failed to write " << file << std::endl;
+		return false;
+	}
+	std::cout << "PACK: " << count << " assets, " << packed.size() << " bytes written to " << file << std::endl;
+	return true;
+}
+
+std::string AssetPack::normalize(const std::string& path)
+{
+	std::string name = path;
+	for (char& c : name)
+		if (c == '\\')
+			c = '/';
+	while (name.compare(0, 2, "./") == 0)
+		name.erase(0, 2);
+	while (name.size() > 1 && name.back() == '/')
+		name.pop_back();
+	return name;
+}
+
+Asset::Asset()
+	: Data(nullptr), Size(0)
+{
+
+}
+
+bool Asset::Open(const std::string& path)
+{
+	this->Close();
+	if (AssetPack::Find(path, this->Data, this->Size))
+		return true;
+	if (!this->file.Open(path))
+		return false;
+	this->Data = this->file.Data;
+	this->Size = this->file.Size;
+	return true;
+}
+
+void Asset::Close()
+{
+	this->file.Close();
+	this->Data = nullptr;
+	this->Size = 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+
+// Header of an asset pack; the slots of the path hash table follow it,
+// then the paths, then the assets, each starting on a PACK_ALIGNMENT boundary
+struct PackHeader {
+	char Magic[4]; // "BPAK"
+	unsigned int Version;
+	unsigned int Count; // assets in the pack
+	unsigned int Slots; // slots of the hash table, a power of two
+};
+
+// A slot of the hash table; free slots have a zero PathLength
+struct PackEntry {
+	unsigned long long Hash; // of the path
+	unsigned long long Offset, Size; // of the asset, from the start of the pack
+	unsigned int Path, PathLength; // the path, from the start of the pack
+};
+
+// Bundles the asset directories into one file (--build-pack) that the game
+// maps once at startup; its assets are then served straight from the
+// mapping instead of opening every file on its own. Paths are looked up
+// in an open addressed hash table (linear probing, at most half full).
+// Assets missing from the pack are still read from their own files.
+class AssetPack
+{
+public:
+	// packed assets start on this boundary, so they can be read in place as any type
+	static const unsigned int PACK_ALIGNMENT = 16;
+	// maps a pack, closing the previous one; false if it can't be opened or isn't a pack
+	static bool Open(const std::string& file);
+	static void Close();
+	static bool IsOpen();
+	static unsigned int Count();
+	// the contents of a packed asset; false if it isn't in the pack
+	static bool Find(const std::string& path, const unsigned char*& data, size_t& size);
+	// packs every file below the directories, paths relative to the working directory
+	static bool Build(const std::string& file, const std::vector<std::string>& directories);
+private:
+	AssetPack() { }
+	// never closed at exit, sounds are played from it until the sound engine is dropped
+	static MappedFile* pack;
+	static PackHeader header;
+	static const PackEntry* slots;
+	// '/' separated, without a leading "./"
+	static std::string normalize(const std::string& path);
+};
+
+// The contents of an asset: a view into the asset pack, or the asset's own
+// file mapped if it isn't packed. Either way nothing is copied; the data
+// stays valid while the Asset is open (and the pack isn't closed).
+class Asset
+{
+public:
+	const unsigned char* Data;
+	size_t Size;
+	Asset();
+	// false if the asset is neither packed nor a readable file
+	bool Open(const std::string& path);
+	void Close();
+private:
+	MappedFile file;
+	Asset(const Asset&) = delete;
+	Asset& operator=(const Asset&) = delete;
+};
@@ -0,0 +1,68 @@
+#include "endless_level.h"
+
+// the ring: the visible rows plus the one entering above them
+const unsigned int RING_ROWS = EndlessLevel::VISIBLE_ROWS + 1;
+
+
+EndlessLevel::EndlessLevel()
+	: Speed(8.0f), Seed(1), Rows(0), levelHeight(0.0f), brickSize(0.0f), bottom(0), bottomY(0.0f)
+{
+
+}
+
+void EndlessLevel::Start(unsigned int levelWidth, unsigned int levelHeight)
+{
+	this->levelHeight = static_cast<float>(levelHeight);
+	this->brickSize = glm::vec2(levelWidth / static_cast<float>(COLUMNS), levelHeight / static_cast<float>(VISIBLE_ROWS));
+	this->solidTexture = ResourceManager::GetTexture("block_solid");
+	this->blockTexture = ResourceManager::GetTexture("block");
+	// the only allocation of the mode
+	this->Bricks.assign(RING_ROWS * COLUMNS, GameObject());
+	this->File.clear();
+	this->Reset();
+}
+
+void EndlessLevel::Reset()
+{
+	this->Rows = 0;
+	// the same seed replays the same rows
+	this->random.Seed(this->Seed);
+	this->bottom = 0;
+	// the lowest row starts in the last visible row, the top one just above the level area
+	this->bottomY = this->levelHeight - this->brickSize.y;
+	for (unsigned int row = 0; row < RING_ROWS; ++row)
+		this->generateRow(row, this->bottomY - row * this->brickSize.y);
+}
+
+void EndlessLevel::Update(float dt)
+{
+	float distance = this->Speed * dt;
+	for (GameObject& brick : this->Bricks)
+		brick.Position.y += distance;
+	this->bottomY += distance;
+	// the lowest row left the level area: its slot becomes the new top row (at most once per slot per update)
+	for (unsigned int i = 0; i < RING_ROWS && this->bottomY >= this->levelHeight; ++i)
+	{
+		this->generateRow(this->bottom, this->bottomY - RING_ROWS * this->brickSize.y);
+		this->bottom = (this->bottom + 1) % RING_ROWS;
+		this->bottomY -= this->brickSize.y;
+	}
+}
+
+void EndlessLevel::generateRow(unsigned int slot, float y)
+{
+	for (unsigned int x = 0; x < COLUMNS; ++x)
+	{
+		// mostly colored bricks, a few gaps and the odd solid block
+		unsigned int roll = this->random.Below(100);
+		unsigned int tile = roll < 8 ? 1 : roll < 25 ? 0 : 2 + this->random.Below(4);
+		GameObject& brick = this->Bricks[slot * COLUMNS + x];
+		glm::vec2 position(x * this->brickSize.x, y);
+		if (!MakeBrick(tile, position, this->brickSize, this->solidTexture, this->blockTexture, brick))
+		{
+			brick.Position = position;
+			brick.Destroyed = true;
+		}
+	}
+	++this->Rows;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "game_level.h"
+#include "level_generator.h"
+
+
+// Endless mode: rows of random bricks scroll down the level area and leave
+// it at the bottom, while new rows enter at the top. The rows live in a
+// ring over a Bricks array sized once, row r of the ring owning the bricks
+// [r * COLUMNS, (r + 1) * COLUMNS); retiring the lowest row regenerates its
+// bricks in place as the new top row. Nothing is ever reallocated, so
+// references to bricks stay valid, and memory and the cost of a frame are
+// the same however long a session runs. Empty tiles are destroyed bricks.
+class EndlessLevel : public GameLevel
+{
+public:
+	static const unsigned int COLUMNS = 15;
+	// rows visible at once; the ring holds one more, entering above the top
+	static const unsigned int VISIBLE_ROWS = 8;
+	// units the rows scroll down per second
+	float Speed;
+	// seeds the rows on every reset
+	unsigned long long Seed;
+	// rows generated since the last reset
+	unsigned long long Rows;
+	EndlessLevel();
+	// sizes the ring for a levelWidth x levelHeight area and fills it with fresh rows
+	void Start(unsigned int levelWidth, unsigned int levelHeight);
+	// fills the ring with fresh rows at their starting positions
+	void Reset();
+	// scrolls the rows down, recycling the row that left the level area
+	void Update(float dt);
+private:
+	float levelHeight;
+	glm::vec2 brickSize;
+	// ring slot of the lowest row and its top edge
+	unsigned int bottom;
+	float bottomY;
+	Xorshift random;
+	Texture2D solidTexture, blockTexture;
+	// fills a ring slot with a new random row whose top edge is at y
+	void generateRow(unsigned int slot, float y);
+};
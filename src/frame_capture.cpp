@@ -0,0 +1,193 @@
+#include "frame_capture.h"
+
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#include <stb_image_write.h>
+
+// RGB only: the output's alpha is whatever blending left behind, viewers would show it as holes
+const unsigned int CHANNELS = 3;
+
+FrameCapture::FrameCapture()
+	: Directory("."), Captured(0), Dropped(0), slots(), next(0), width(0), height(0), recording(false),
+	file(nullptr), screenshots(0), recordings(0), writer(1)
+{
+	for (unsigned int i = 0; i < BUFFERS; ++i)
+		this->free.push_back(&this->storage[i]);
+}
+
+FrameCapture::~FrameCapture()
+{
+	this->StopRecording();
+	// the writer drains its queue before its thread is joined
+}
+
+void FrameCapture::Capture(unsigned int framebuffer, unsigned int width, unsigned int height, bool screenshot, bool record)
+{
+	if (width != this->width || height != this->height)
+		this->allocate(width, height);
+	this->Poll();
+	Slot& slot = this->slots[this->next];
+	if (slot.Fence)
+	{
+		// every pixel buffer is still being read, the GPU is too far behind
+		++this->Dropped;
+		return;
+	}
+	if (record)
+		this->recording = true;
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	// with a pack buffer bound this only queues the copy, the data pointer is an offset into the buffer
+	glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.Screenshot = screenshot;
+	slot.Record = record;
+	this->next = (this->next + 1) % SLOTS;
+}
+
+void FrameCapture::Poll()
+{
+	// readbacks finish in order, so stop at the first one that isn't done
+	for (unsigned int i = 0; i < SLOTS; ++i)
+	{
+		Slot& slot = this->slots[(this->next + i) % SLOTS];
+		if (slot.Fence && !this->collect(slot, false))
+			break;
+	}
+}
+
+void FrameCapture::StopRecording()
+{
+	if (!this->recording)
+		return;
+	this->recording = false;
+	// frames still being read back belong to this recording, they are written before it is closed
+	for (unsigned int i = 0; i < SLOTS; ++i)
+	{
+		Slot& slot = this->slots[(this->next + i) % SLOTS];
+		if (slot.Fence)
+			this->collect(slot, true);
+	}
+	this->writer.Enqueue([this]() {
+		if (this->file)
+			std::fclose(this->file);
+		this->file = nullptr;
+	});
+}
+
+void FrameCapture::Finish()
+{
+	for (unsigned int i = 0; i < SLOTS; ++i)
+	{
+		Slot& slot = this->slots[(this->next + i) % SLOTS];
+		if (slot.Fence)
+			this->collect(slot, true);
+		if (slot.PBO)
+			glDeleteBuffers(1, &slot.PBO);
+		slot.PBO = 0;
+	}
+	this->width = this->height = 0;
+	if (this->Captured > 0 || this->Dropped > 0)
+		std::cout << "CAPTURE: " << this->Captured << " frames written, " << this->Dropped << " dropped" << std::endl;
+}
+
+void FrameCapture::allocate(unsigned int width, unsigned int height)
+{
+	// a raw recording can't change its frame size, so it continues in a new file
+	if (this->recording)
+	{
+		this->StopRecording();
+		this->recording = true;
+	}
+	// frames of the old size are finished first, then the buffers are resized
+	for (unsigned int i = 0; i < SLOTS; ++i)
+	{
+		Slot& slot = this->slots[(this->next + i) % SLOTS];
+		if (slot.Fence)
+			this->collect(slot, true);
+	}
+	this->width = width;
+	this->height = height;
+	for (Slot& slot : this->slots)
+	{
+		if (!slot.PBO)
+			glGenBuffers(1, &slot.PBO);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+		glBufferData(GL_PIXEL_PACK_BUFFER, width * height * CHANNELS, nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+bool FrameCapture::collect(Slot& slot, bool wait)
+{
+	GLenum status = glClientWaitSync(slot.Fence, 0, wait ? 1000000000ull : 0);
+	if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return false;
+	glDeleteSync(slot.Fence);
+	slot.Fence = nullptr;
+
+	std::vector<unsigned char>* pixels = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (!this->free.empty())
+		{
+			pixels = this->free.back();
+			this->free.pop_back();
+		}
+	}
+	if (!pixels)
+	{
+		// the writer can't keep up; dropping keeps the memory bounded
+		++this->Dropped;
+		return true;
+	}
+	unsigned int rowSize = this->width * CHANNELS;
+	pixels->resize(rowSize * this->height);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+	const unsigned char* mapped = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowSize * this->height, GL_MAP_READ_BIT));
+	if (mapped)
+	{
+		// OpenGL's rows start at the bottom, the files' at the top
+		for (unsigned int y = 0; y < this->height; ++y)
+			std::memcpy(&(*pixels)[y * rowSize], mapped + (this->height - 1 - y) * rowSize, rowSize);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	unsigned int width = this->width, height = this->height;
+	bool screenshot = slot.Screenshot, record = slot.Record;
+	this->writer.Enqueue([this, pixels, width, height, screenshot, record]() {
+		this->write(pixels, width, height, screenshot, record);
+	});
+	return true;
+}
+
+void FrameCapture::write(std::vector<unsigned char>* pixels, unsigned int width, unsigned int height, bool screenshot, bool record)
+{
+	char name[64];
+	if (screenshot)
+	{
+		std::snprintf(name, sizeof(name), "/screenshot_%lld_%u.png", static_cast<long long>(std::time(nullptr)), this->screenshots++);
+		if (!stbi_write_png((this->Directory + name).c_str(), width, height, CHANNELS, pixels->data(), width * CHANNELS))
+			std::cout << "ERROR::CAPTURE: Failed to write screenshot: " << this->Directory + name << std::endl;
+	}
+	if (record)
+	{
+		if (!this->file)
+		{
+			std::snprintf(name, sizeof(name), "/capture_%lld_%u_%ux%u.rgb", static_cast<long long>(std::time(nullptr)), this->recordings++, width, height);
+			this->file = std::fopen((this->Directory + name).c_str(), "wb");
+			if (!this->file)
+				std::cout << "ERROR::CAPTURE: Failed to open recording: " << this->Directory + name << std::endl;
+		}
+		if (this->file)
+			std::fwrite(pixels->data(), 1, pixels->size(), this->file);
+	}
+	++this->Captured;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->free.push_back(pixels);
+}
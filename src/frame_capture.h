@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "thread_pool.h"
+
+
+// FrameCapture reads finished frames back without stalling the frame.
+// glReadPixels writes into a ring of pixel buffer objects and is fenced;
+// a few frames later, once the GPU is done, the buffer is mapped and
+// copied into one of a fixed pool of CPU frames. A writer thread encodes
+// and writes that frame. Screenshots become PNGs. Recordings are appended
+// to one raw RGB file per recording (top row first), which can be
+// converted with, e.g.,
+//     ffmpeg -f rawvideo -pix_fmt rgb24 -s 800x600 -r 60 -i capture.rgb capture.mp4
+// Memory stays bounded: if the GPU or the writer falls behind, frames are
+// dropped and counted instead of queueing up.
+class FrameCapture
+{
+public:
+	// pixel buffers the readbacks rotate through
+	static const unsigned int SLOTS = 3;
+	// CPU frames that may wait for the writer at once
+	static const unsigned int BUFFERS = 6;
+	// directory the files are written to
+	std::string Directory;
+	// frames written and frames that had to be skipped
+	std::atomic<unsigned int> Captured, Dropped;
+	FrameCapture();
+	// waits for the writer; call Finish before, while the GL context is still current
+	~FrameCapture();
+	// reads the color buffer of a framebuffer; screenshot writes a PNG, record appends the frame to the recording
+	void Capture(unsigned int framebuffer, unsigned int width, unsigned int height, bool screenshot, bool record);
+	// hands finished readbacks to the writer; call every frame, whether capturing or not
+	void Poll();
+	// closes the current recording file once the frames in flight are written (GL thread); the next recorded frame starts a new one
+	void StopRecording();
+	// waits for the readbacks in flight, hands them to the writer and deletes the GL objects
+	void Finish();
+private:
+	// a readback into a pixel buffer
+	struct Slot {
+		unsigned int PBO;
+		GLsync Fence; // nullptr while the slot is free
+		bool Screenshot, Record;
+	};
+	Slot slots[SLOTS];
+	unsigned int next; // slot of the next readback, the oldest one still in flight is the first busy one after it
+	unsigned int width, height;
+	bool recording;
+	// CPU frames not handed to the writer
+	std::vector<std::vector<unsigned char>*> free;
+	std::vector<unsigned char> storage[BUFFERS];
+	std::mutex mutex;
+	// only the writer touches the files, a single worker keeps the frames in order
+	std::FILE* file;
+	// numbers the files, so files started within the same second get different names
+	unsigned int screenshots, recordings;
+	ThreadPool writer;
+	// (re)creates the pixel buffers for a new frame size
+	void allocate(unsigned int width, unsigned int height);
+	// copies a finished readback out and queues it for writing; wait blocks until the GPU is done
+	bool collect(Slot& slot, bool wait);
+	// writes a frame on the writer thread
+	void write(std::vector<unsigned char>* pixels, unsigned int width, unsigned int height, bool screenshot, bool record);
+};
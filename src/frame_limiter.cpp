@@ -0,0 +1,52 @@
+#include "frame_limiter.h"
+
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "winmm.lib") // timeBeginPeriod
+#endif
+
+// time before a deadline that is spent yielding instead of sleeping
+const std::chrono::microseconds SPIN_MARGIN(1500);
+
+FrameLimiter::FrameLimiter()
+	: started(false)
+{
+#ifdef _WIN32
+	// the default timer resolution makes sleeps overshoot by up to 15.6 ms
+	timeBeginPeriod(1);
+#endif
+}
+
+FrameLimiter::~FrameLimiter()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FrameLimiter::Wait(double rate)
+{
+	if (rate <= 0.0)
+	{
+		this->started = false;
+		return;
+	}
+	std::chrono::steady_clock::duration period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (!this->started || now - this->deadline > period)
+		this->deadline = now;
+	this->deadline += period;
+	this->started = true;
+	if (this->deadline - now > SPIN_MARGIN)
+		std::this_thread::sleep_until(this->deadline - SPIN_MARGIN);
+	while (std::chrono::steady_clock::now() < this->deadline)
+		std::this_thread::yield();
+}
+
+void FrameLimiter::Reset()
+{
+	this->started = false;
+}
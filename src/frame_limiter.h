@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chrono>
+
+
+// FrameLimiter paces a loop to a target frame rate. It sleeps through most
+// of the time left in a frame and yields in a loop for the last stretch,
+// since an OS sleep can overshoot by a scheduler tick. Deadlines advance by
+// whole frames, so the average rate stays exact; a loop that falls behind
+// by more than a frame starts over instead of rushing to catch up.
+class FrameLimiter
+{
+public:
+	FrameLimiter();
+	~FrameLimiter();
+	// waits for the end of the current frame at the given rate; 0 doesn't wait
+	void Wait(double rate);
+	// forgets the previous deadline, e.g. after the loop was idle
+	void Reset();
+private:
+	std::chrono::steady_clock::time_point deadline;
+	bool started;
+};
@@ -0,0 +1,63 @@
+#include "frame_log.h"
+
+#include <iostream>
+
+
+FrameLog::FrameLog()
+	: json(false), rows(0)
+{
+
+}
+
+FrameLog::~FrameLog()
+{
+	if (this->stream.is_open() && this->json)
+		this->stream << (this->rows > 0 ? "\n]\n" : "[]\n");
+}
+
+bool FrameLog::Open(const std::string& file)
+{
+	this->stream.open(file, std::ios::trunc);
+	if (!this->stream)
+	{
+		std::cout << "ERROR::FRAMELOG: Failed to open log file: " << file << std::endl;
+		return false;
+	}
+	this->json = file.size() >= 5 && file.compare(file.size() - 5, 5, ".json") == 0;
+	this->rows = 0;
+	return true;
+}
+
+void FrameLog::Write(unsigned int frame, const std::vector<LogColumn>& columns)
+{
+	if (!this->stream.is_open())
+		return;
+	if (this->json)
+	{
+		this->stream << (this->rows == 0 ? "[\n" : ",\n") << "{\"frame\":" << frame;
+		for (const LogColumn& column : columns)
+			this->stream << ",\"" << column.Name << "\":" << column.Value;
+		this->stream << "}";
+	}
+	else
+	{
+		// the header is written with the first row, once the columns are known
+		if (this->rows == 0)
+		{
+			this->stream << "frame";
+			for (const LogColumn& column : columns)
+				this->stream << "," << column.Name;
+			this->stream << "\n";
+		}
+		this->stream << frame;
+		for (const LogColumn& column : columns)
+			this->stream << "," << column.Value;
+		this->stream << "\n";
+	}
+	++this->rows;
+}
+
+bool FrameLog::IsOpen() const
+{
+	return this->stream.is_open();
+}
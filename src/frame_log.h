@@ -0,0 +1,33 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+// A named value of a frame
+struct LogColumn {
+	std::string Name;
+	float Value;
+};
+
+// FrameLog writes per-frame measurements (GPU times, counters) to a file,
+// as CSV (one column per value) or, if the file name ends in .json, as a
+// JSON array of objects, so they can be plotted as time series.
+class FrameLog
+{
+public:
+	FrameLog();
+	// finishes the file (closes the JSON array)
+	~FrameLog();
+	// starts a new log, returns false if the file can't be written
+	bool Open(const std::string& file);
+	// appends a frame; the columns have to be the same (and in the same order) every frame
+	void Write(unsigned int frame, const std::vector<LogColumn>& columns);
+	// true while a log is being written
+	bool IsOpen() const;
+private:
+	std::ofstream stream;
+	bool json;
+	unsigned int rows;
+};
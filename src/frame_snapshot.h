@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "render_queue.h"
+
+
+// Post-processing effects toggled by the game
+struct EffectFlags {
+	bool Confuse, Chaos, Shake;
+};
+
+// Renderer configuration requested by the game (quality tier, resolution, toggled passes)
+struct RenderSettings {
+	float Scale;          // scene resolution relative to the output
+	unsigned int Samples; // MSAA samples, 0 = off
+	float PassScale;      // resolution factor of the post-processing chain
+	unsigned int Passes;  // bit i enables PostProcessor::Passes[i]
+	bool Overlay;         // draws the GPU time breakdown (GL backend only)
+	bool Counters;        // draws the GL call counters (GL backend only)
+	unsigned int Screenshots; // a screenshot is taken whenever this changes (GL backend only)
+	bool Recording;       // captures every frame to a raw video file (GL backend only)
+};
+
+// Text drawn on top of the post-processed scene
+struct TextCommand {
+	std::string Text;
+	float X, Y, Scale;
+	glm::vec3 Color;
+};
+
+// Everything needed to draw one frame. The simulation fills a snapshot and
+// publishes it; from then on it is only read by the renderer, so both can
+// work on different frames at the same time.
+struct FrameSnapshot {
+	unsigned int Frame;
+	float Time;
+	EffectFlags Effects;
+	RenderSettings Settings;
+	std::vector<RenderCommand> Commands; // sorted scene quads
+	std::vector<TextCommand> Texts;      // HUD, drawn after post-processing
+};
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
 
 #include <irrKlang/irrKlang.h>
 
@@ -10,21 +11,71 @@
 #include "game_object.h"
 #include "ball_object.h"
 #include "particle_generator.h"
-#include "post_processor.h"
-#include "text_renderer.h"
+#include "render_queue.h"
+#include "renderer.h"
+#include "frame_snapshot.h"
+#include "resolution_scaler.h"
+#include "quality_governor.h"
+#include "texture_cache.h"
+#include "program_cache.h"
+#include "hot_reload.h"
+#include "endless_level.h"
+#include "asset_pack.h"
 
 #pragma comment(lib, "irrKlang.lib") // link with irrKlang.dll
 
 // Game-related State data
-SpriteRenderer* Renderer;
+// backend drawing the snapshots
+Renderer* Backend = nullptr;
+RenderQueue* Queue;
 GameObject* Player;
 BallObject* Ball;
 ParticleGenerator* Particles;
-PostProcessor* Effects;
 irrklang::ISoundEngine* SoundEngine = irrklang::createIrrKlangDevice();
-TextRenderer* Text;
+ResolutionScaler Resolution;
+QualityGovernor Quality;
+// streamed rows of endless mode, selected after the last level of the manifest
+EndlessLevel Endless;
+// watches the asset directories, nullptr unless WatchAssets was called
+HotReload* Reloader = nullptr;
+// textures drawn every frame or picked on every spawn, interned once by Init
+TextureHandle BackgroundTexture;
+TextureHandle SpeedTexture, StickyTexture, IncreaseTexture, ConfuseTexture, ChaosTexture, PassThroughTexture;
+
+// state the simulation hands to the renderer with every snapshot
+EffectFlags ActiveEffects = { false, false, false };
+RenderSettings Settings = { 1.0f, 4, 1.0f, 0, false, false, 0, false };
+// snapshot used when rendering on the simulation thread
+FrameSnapshot LocalSnapshot;
+unsigned int FrameCount = 0;
+
+// applies the knobs of a quality tier to the particles and render settings
+void ApplyQualityTier(const QualityTier& tier);
+
+// post-processing chain passes toggled by keys 1-5
+const char* TOGGLE_PASSES[] = { "blur", "edge", "invert", "bloom", "crt" };
 
 float ShakeTime = 0.0f;
+// simulated time passed to the shaders; advanced by Update so scripted runs render the same frames
+float ElapsedTime = 0.0f;
+
+// startup timing, reported by the thread drawing the frames
+std::chrono::steady_clock::time_point InitStart;
+bool FirstFrameReported = false;
+bool LoadingReported = false;
+
+// plays a sound if an audio device could be opened (there is none on headless machines)
+void PlayAudio(const char* file, bool looped)
+{
+	if (!SoundEngine)
+		return;
+	// packed sounds play from the pack's mapping, registered under their path on first use
+	const unsigned char* data;
+	size_t size;
+	if (!SoundEngine->getSoundSource(file, false) && AssetPack::Find(file, data, size))
+		SoundEngine->addSoundSourceFromMemory(const_cast<unsigned char*>(data), static_cast<irrklang::ik_s32>(size), file, false);
+	SoundEngine->play2D(file, looped);
+}
 
 
 Game::Game(unsigned int width, unsigned int height)
@@ -35,80 +86,74 @@ Game::Game(unsigned int width, unsigned int height)
 
 Game::~Game()
 {
-	delete Renderer;
+	delete Queue;
 	delete Player;
 	delete Ball;
 	delete Particles;
-	delete Effects;
-	delete Text;
-	SoundEngine->drop();
+	delete Reloader;
+	if (SoundEngine)
+		SoundEngine->drop();
+}
+
+void Game::SetRenderer(Renderer* renderer)
+{
+	Backend = renderer;
 }
 
 void Game::Init()
 {
-	// load shaders
-	ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.frag", nullptr, "sprite");
-	ResourceManager::LoadShader("shaders/particle.vs", "shaders/particle.frag", nullptr, "particle");
-	ResourceManager::LoadShader("shaders/post_processing.vs", "shaders/post_processing.frag", nullptr, "postprocessing");
-	// configure shaders
-	glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width),
-		static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
-	ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-	ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
-	ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-	ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
-	// load texture
-	ResourceManager::LoadTexture("textures/background.jpg", false, "background");
+	InitStart = std::chrono::steady_clock::now();
+	// the backend loads its shaders first and decides whether textures go to GL at all
+	Backend->Init(this->Width, this->Height);
+	// load textures; decoded on worker threads, placeholders are drawn until they are uploaded
+	BackgroundTexture = ResourceManager::LoadTexture("textures/background.jpg", false, "background");
 	ResourceManager::LoadTexture("textures/awesomeface.png", true, "face");
 	ResourceManager::LoadTexture("textures/block.png", false, "block");
 	ResourceManager::LoadTexture("textures/block_solid.png", false, "block_solid");
 	ResourceManager::LoadTexture("textures/paddle.png", true, "paddle");
 	ResourceManager::LoadTexture("textures/particle.png", true, "particle");
-	ResourceManager::LoadTexture("textures/powerup_speed.png", true, "powerup_speed");
-	ResourceManager::LoadTexture("textures/powerup_sticky.png", true, "powerup_sticky");
-	ResourceManager::LoadTexture("textures/powerup_increase.png", true, "powerup_increase");
-	ResourceManager::LoadTexture("textures/powerup_confuse.png", true, "powerup_confuse");
-	ResourceManager::LoadTexture("textures/powerup_chaos.png", true, "powerup_chaos");
-	ResourceManager::LoadTexture("textures/powerup_passthrough.png", true, "powerup_passthrough");
+	SpeedTexture = ResourceManager::LoadTexture("textures/powerup_speed.png", true, "powerup_speed");
+	StickyTexture = ResourceManager::LoadTexture("textures/powerup_sticky.png", true, "powerup_sticky");
+	IncreaseTexture = ResourceManager::LoadTexture("textures/powerup_increase.png", true, "powerup_increase");
+	ConfuseTexture = ResourceManager::LoadTexture("textures/powerup_confuse.png", true, "powerup_confuse");
+	ChaosTexture = ResourceManager::LoadTexture("textures/powerup_chaos.png", true, "powerup_chaos");
+	PassThroughTexture = ResourceManager::LoadTexture("textures/powerup_passthrough.png", true, "powerup_passthrough");
 
 	// set render-specific controls
-	auto _shader = ResourceManager::GetShader("sprite");
-	Renderer = new SpriteRenderer(_shader);
-	Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
-	Effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->Width, this->Height);
-	Text = new TextRenderer(this->Width, this->Height);
-	Text->Load("fonts/arial.ttf", 24);
-	// load levels
-	GameLevel one;
-	one.Load("levels/one.lvl", this->Width, this->Height / 2);
-	GameLevel two;
-	two.Load("levels/two.lvl", this->Width, this->Height / 2);
-	GameLevel three;
-	three.Load("levels/three.lvl", this->Width, this->Height / 2);
-	GameLevel four;
-	four.Load("levels/four.lvl", this->Width, this->Height / 2);
-	this->Levels.push_back(one);
-	this->Levels.push_back(two);
-	this->Levels.push_back(three);
-	this->Levels.push_back(four);
+	// the queue only sorts here, the backend draws the sorted commands
+	Queue = new RenderQueue(ResourceManager::GetShader("sprite_batch"), nullptr);
+	Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), Quality.Current().Particles);
+	Backend->LoadFont("fonts/arial.ttf", 24);
+	ApplyQualityTier(Quality.Current());
+	// levels are listed in the manifest and loaded as they are selected
+	this->Levels.Load("levels/manifest.txt", this->Width, this->Height / 2);
 	this->Level = 0;
+	this->Levels.Select(this->Level);
+	Endless.Start(this->Width, this->Height / 2);
 
 	glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
 	Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
 	glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
 	Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
 	// audio
-	SoundEngine->play2D("audios/breakout.mp3", true);
+	PlayAudio("audios/breakout.mp3", true);
 }
 
 void Game::Update(float dt)
 {
+	// prefetched levels are taken over between updates
+	this->Levels.Update();
+	if (Reloader)
+		Reloader->ApplyLevels(this->Levels, this->Width, this->Height / 2);
+	ElapsedTime += dt;
+	if (this->State == GAME_ACTIVE && this->Level >= this->Levels.Count())
+		Endless.Update(dt);
 	// update objects
 	Ball->Move(dt, this->Width);
 	// check for collisions
 	this->DoCollisions();
-	// update particles
-	Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f));
+	// update particles; only a ball in play leaves a trail, so the menus come to rest
+	Particles->Update(dt, *Ball, this->State == GAME_ACTIVE ? Quality.Current().ParticlesPerFrame : 0, glm::vec2(Ball->Radius / 2.0f));
 	// update PowerUps
 	this->UpdatePowerUps(dt);
 	// reduce shake time
@@ -116,7 +161,7 @@ void Game::Update(float dt)
 	{
 		ShakeTime -= dt;
 		if (ShakeTime <= 0.0f)
-			Effects->Shake = false;
+			ActiveEffects.Shake = false;
 	}
 	// check loss condition
 	if (Ball->Position.y >= this->Height) // did ball reach bottom edge?
@@ -131,11 +176,12 @@ void Game::Update(float dt)
 		this->ResetPlayer();
 	}
 	// check win condition
-	if (this->State == GAME_ACTIVE && this->Levels[this->Level].IsCompleted())
+	// endless mode can't be won
+	if (this->State == GAME_ACTIVE && this->Level < this->Levels.Count() && this->ActiveLevel().IsCompleted())
 	{
 		this->ResetLevel();
 		this->ResetPlayer();
-		Effects->Chaos = true;
+		ActiveEffects.Chaos = true;
 		this->State = GAME_WIN;
 	}
 }
@@ -143,6 +189,41 @@ void Game::Update(float dt)
 
 void Game::ProcessInput(float dt)
 {
+	// toggle the post-processing chain passes
+	for (unsigned int i = 0; i < sizeof(TOGGLE_PASSES) / sizeof(TOGGLE_PASSES[0]); ++i)
+	{
+		int key = GLFW_KEY_1 + i;
+		if (this->Keys[key] && !this->KeysProcessed[key])
+		{
+			int pass = Backend->PassIndex(TOGGLE_PASSES[i]);
+			if (pass >= 0)
+				Settings.Passes ^= 1u << pass;
+			this->KeysProcessed[key] = true;
+		}
+	}
+	// toggle the GPU time overlay
+	if (this->Keys[GLFW_KEY_F1] && !this->KeysProcessed[GLFW_KEY_F1])
+	{
+		Settings.Overlay = !Settings.Overlay;
+		this->KeysProcessed[GLFW_KEY_F1] = true;
+	}
+	// toggle the GL call counters
+	if (this->Keys[GLFW_KEY_F2] && !this->KeysProcessed[GLFW_KEY_F2])
+	{
+		Settings.Counters = !Settings.Counters;
+		this->KeysProcessed[GLFW_KEY_F2] = true;
+	}
+	// take a screenshot / start or stop recording the frames
+	if (this->Keys[GLFW_KEY_F12] && !this->KeysProcessed[GLFW_KEY_F12])
+	{
+		++Settings.Screenshots;
+		this->KeysProcessed[GLFW_KEY_F12] = true;
+	}
+	if (this->Keys[GLFW_KEY_F10] && !this->KeysProcessed[GLFW_KEY_F10])
+	{
+		Settings.Recording = !Settings.Recording;
+		this->KeysProcessed[GLFW_KEY_F10] = true;
+	}
 	if (this->State == GAME_MENU)
 	{
 		if (this->Keys[GLFW_KEY_ENTER] && !this->KeysProcessed[GLFW_KEY_ENTER])
@@ -152,7 +233,9 @@ void Game::ProcessInput(float dt)
 		}
 		if (this->Keys[GLFW_KEY_W] && !this->KeysProcessed[GLFW_KEY_W])
 		{
-			this->Level = (this->Level + 1) % 4;
+			// the entry after the last level is endless mode
+			this->Level = (this->Level + 1) % (this->Levels.Count() + 1);
+			this->Levels.Select(this->Level);
 			this->KeysProcessed[GLFW_KEY_W] = true;
 			this->KeysProcessed[GLFW_KEY_S] = false;
 		}
@@ -161,7 +244,8 @@ void Game::ProcessInput(float dt)
 			if (this->Level > 0)
 				--this->Level;
 			else
-				this->Level = 3;
+				this->Level = this->Levels.Count();
+			this->Levels.Select(this->Level);
 			this->KeysProcessed[GLFW_KEY_S] = true;
 			this->KeysProcessed[GLFW_KEY_W] = false;
 		}
@@ -171,7 +255,7 @@ void Game::ProcessInput(float dt)
 		if (this->Keys[GLFW_KEY_ENTER])
 		{
 			this->KeysProcessed[GLFW_KEY_ENTER] = true;
-			Effects->Chaos = false;
+			ActiveEffects.Chaos = false;
 			this->State = GAME_MENU;
 		}
 	}
@@ -202,64 +286,144 @@ void Game::ProcessInput(float dt)
 	}
 }
 
+bool Game::IsAnimating() const
+{
+	// textures are only uploaded while frames are drawn, so loads in progress keep the loop running
+	return this->State == GAME_ACTIVE || ActiveEffects.Chaos || ActiveEffects.Confuse || ActiveEffects.Shake || Particles->IsAlive() ||
+		(Reloader && Reloader->Busy()) || ResourceManager::PendingLoads() > 0;
+}
+
+GameLevel& Game::ActiveLevel()
+{
+	if (this->Level < this->Levels.Count())
+		return this->Levels.Get(this->Level);
+	return Endless;
+}
+
+void Game::WatchAssets()
+{
+	Reloader = new HotReload();
+	if (Reloader->Start({ "shaders", "textures", "levels" }))
+		std::cout << "RELOAD: watching shaders, textures and levels" << std::endl;
+}
+
 void Game::Render()
 {
+	this->BuildSnapshot(LocalSnapshot);
+	this->RenderSnapshot(LocalSnapshot);
+}
+
+void Game::BuildSnapshot(FrameSnapshot& snapshot)
+{
+	snapshot.Frame = FrameCount++;
+	snapshot.Time = ElapsedTime;
+	snapshot.Effects = ActiveEffects;
+	snapshot.Settings = Settings;
+	snapshot.Texts.clear();
 	if (this->State == GAME_ACTIVE || this->State == GAME_MENU || this->State == GAME_WIN)
 	{
-		// begin rendering to postprocessing framebuffer
-		Effects->BeginRender();
-		// draw background
-		auto _background = ResourceManager::GetTexture("background");
-		Renderer->DrawSprite(_background, glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
-		// draw level
-		this->Levels[this->Level].Draw(*Renderer);
-		// draw player
-		Player->Draw(*Renderer);
-		// draw PowerUps
+		// queue background
+		Queue->Submit(LAYER_BACKGROUND, BLEND_ALPHA, ResourceManager::GetTexture(BackgroundTexture), glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height));
+		// queue level
+		this->ActiveLevel().Draw(*Queue);
+		// queue player
+		Player->Draw(*Queue, LAYER_PLAYER);
+		// queue PowerUps
 		for (PowerUp& powerUp : this->PowerUps)
 			if (!powerUp.Destroyed)
-				powerUp.Draw(*Renderer);
-		// draw particles
-		Particles->Draw();
-		// draw ball
-		Ball->Draw(*Renderer);
-		// end rendering to postprocessing framebuffer
-		Effects->EndRender();
-		// render postprocessing quad
-		Effects->Render(glfwGetTime());
-
-		// rendering text (don't include in postprocessing)
+				powerUp.Draw(*Queue, LAYER_POWERUPS);
+		// queue particles
+		Particles->Draw(*Queue);
+		// queue ball
+		Ball->Draw(*Queue, LAYER_BALL);
+
+		// text (don't include in postprocessing)
 		std::stringstream ss;
 		ss << this->Lives;
-		Text->RenderText("Lives: " + ss.str(), 5.0f, 5.0f, 1.0f);
-	
+		snapshot.Texts.push_back({ "Lives: " + ss.str(), 5.0f, 5.0f, 1.0f, glm::vec3(1.0f) });
 	}
-	//auto _texture = ResourceManager::GetTexture("face");
-	//Renderer->DrawSprite(_texture, glm::vec2(200.0f, 200.0f), glm::vec2(300.0f, 400.0f), 45.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-	
+	// sort here so the render thread only has to submit
+	Queue->Sort(snapshot.Commands);
+
 	if (this->State == GAME_MENU)
 	{
-		Text->RenderText("Press ENTER to start", 250.0f, this->Height / 2.0f, 1.0f);
-		Text->RenderText("Press W or S to select level", 245.0f, this->Height / 2.0f + 20.0f, 0.75f);
+		snapshot.Texts.push_back({ "Press ENTER to start", 250.0f, this->Height / 2.0f, 1.0f, glm::vec3(1.0f) });
+		snapshot.Texts.push_back({ "Press W or S to select level", 245.0f, this->Height / 2.0f + 20.0f, 0.75f, glm::vec3(1.0f) });
+		std::stringstream level;
+		if (this->Level < this->Levels.Count())
+			level << "Level " << this->Level + 1 << ": " << this->Levels.Entry(this->Level).Name;
+		else
+			level << "Endless mode";
+		snapshot.Texts.push_back({ level.str(), 245.0f, this->Height / 2.0f + 40.0f, 0.75f, glm::vec3(1.0f) });
 	}
+	// the quality tier in use, on the menu and next to the GL call counters (F2)
+	if (this->State == GAME_MENU || Settings.Counters)
+		snapshot.Texts.push_back({ "Quality: " + Quality.Current().Name, 5.0f, this->Height - 20.0f, 0.5f, glm::vec3(1.0f) });
 	if (this->State == GAME_WIN)
 	{
-		Text->RenderText("You WON!!!", 320.0f, this->Height / 2.0f - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-		Text->RenderText("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2.0f, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
+		snapshot.Texts.push_back({ "You WON!!!", 320.0f, this->Height / 2.0f - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f) });
+		snapshot.Texts.push_back({ "Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2.0f, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f) });
 	}
 }
 
-void Game::ResetLevel()
+void Game::RenderSnapshot(const FrameSnapshot& snapshot)
+{
+	// textures decoded since the last frame are uploaded here, on the thread owning the context
+	unsigned int pendingLoads = ResourceManager::ProcessTextureLoads();
+	// changed assets are swapped in between frames too
+	if (Reloader)
+		Reloader->ApplyAssets(Backend);
+	Backend->Render(snapshot);
+	if (!FirstFrameReported || (!LoadingReported && pendingLoads == 0))
+	{
+		float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - InitStart).count();
+		if (!FirstFrameReported)
+			std::cout << "LOADING: first frame after " << milliseconds << " ms (" << ProgramCache::Hits
+				<< " programs from the cache, " << ProgramCache::Misses << " compiled)" << std::endl;
+		if (!LoadingReported && pendingLoads == 0)
+			std::cout << "LOADING: all textures loaded after " << milliseconds << " ms (" << TextureCache::Hits
+				<< " from the cache, " << TextureCache::Bakes << " baked)" << std::endl;
+		FirstFrameReported = true;
+		LoadingReported = pendingLoads == 0;
+	}
+}
+
+void Game::Resize(unsigned int width, unsigned int height)
+{
+	Backend->Resize(width, height);
+}
+
+void Game::ReportFrameTime(float milliseconds)
+{
+	// the scene resolution is bound by whichever of CPU and GPU is slower
+	float frameTime = std::max(milliseconds, Backend->GpuTime());
+	if (Resolution.Update(frameTime))
+		Settings.Scale = Resolution.Scale;
+	// the coarse quality tiers only move once the resolution can't absorb the load any more
+	if (Quality.Update(frameTime, Resolution.Scale <= Resolution.MinScale, Resolution.Scale >= Resolution.MaxScale))
+		ApplyQualityTier(Quality.Current());
+}
+
+void ApplyQualityTier(const QualityTier& tier)
 {
-	if (this->Level == 0)
-		this->Levels[0].Load("levels/one.lvl", this->Width, this->Height / 2);
-	else if (this->Level == 1)
-		this->Levels[1].Load("levels/two.lvl", this->Width, this->Height / 2);
-	else if (this->Level == 2)
-		this->Levels[2].Load("levels/three.lvl", this->Width, this->Height / 2);
-	else if (this->Level == 3)
-		this->Levels[3].Load("levels/four.lvl", this->Width, this->Height / 2);
+	Particles->SetAmount(tier.Particles);
+	Settings.Samples = tier.Samples;
+	Settings.PassScale = tier.PassScale;
+	// not every backend has the post-processing chain
+	int pass = Backend->PassIndex("fxaa");
+	if (pass < 0)
+		return;
+	unsigned int fxaa = 1u << pass;
+	Settings.Passes = tier.Fxaa ? Settings.Passes | fxaa : Settings.Passes & ~fxaa;
+}
 
+void Game::ResetLevel()
+{
+	// back to the layout as loaded, no file access
+	if (this->Level < this->Levels.Count())
+		this->ActiveLevel().Reset();
+	else
+		Endless.Reset();
 }
 
 void Game::ResetPlayer()
@@ -269,7 +433,7 @@ void Game::ResetPlayer()
 	Player->Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
 	Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
 	// also disable all active powerups
-	Effects->Chaos = Effects->Confuse = false;
+	ActiveEffects.Chaos = ActiveEffects.Confuse = false;
 	Ball->PassThrough = Ball->Sticky = false;
 	Player->Color = glm::vec3(1.0f);
 	Ball->Color = glm::vec3(1.0f);	
@@ -314,7 +478,7 @@ void Game::UpdatePowerUps(float dt)
 					if (!IsOtherPowerUpActive(this->PowerUps, "confuse"))
 					{
 						// only reset if no other PowerUp of type confuse is active
-						Effects->Confuse = false;
+						ActiveEffects.Confuse = false;
 					}
 				}
 				else if (powerUp.Type == "chaos")
@@ -322,7 +486,7 @@ void Game::UpdatePowerUps(float dt)
 					if (!IsOtherPowerUpActive(this->PowerUps, "chaos"))
 					{
 						// only reset if no other PowerUp of type chaos is active
-						Effects->Chaos = false;
+						ActiveEffects.Chaos = false;
 					}
 				}
 			}
@@ -347,33 +511,33 @@ void Game::SpawnPowerUps(GameObject& block)
 {
 	if (ShouldSpawn(75)) // 1 in 75 chance
 	{
-		this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_speed")));
+		this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture(SpeedTexture)));
 	}
 	if (ShouldSpawn(75))
 	{
-		this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_sticky")));
+		this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture(StickyTexture)));
 
 	}
 
 	if (ShouldSpawn(75))
 	{
-		this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("powerup_passthrough")));
+		this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture(PassThroughTexture)));
 
 	}
 	if (ShouldSpawn(75))
 	{
-		this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_increase")));
+		this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4f), 0.0f, block.Position, ResourceManager::GetTexture(IncreaseTexture)));
 	}
 
 	if (ShouldSpawn(15)) // Negative powerups should spawn more often
 	{
-		this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_confuse")));
+		this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture(ConfuseTexture)));
 
 	}
 	if (ShouldSpawn(15))
 	{
 
-		this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_chaos")));
+		this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture(ChaosTexture)));
 	}
 
 }
@@ -400,13 +564,13 @@ void ActivatePowerUp(PowerUp& powerUp)
 	}
 	else if (powerUp.Type == "confuse")
 	{
-		if (!Effects->Chaos)
-			Effects->Confuse = true; // only activate if chaos wasn't already active
+		if (!ActiveEffects.Chaos)
+			ActiveEffects.Confuse = true; // only activate if chaos wasn't already active
 	}
 	else if (powerUp.Type == "chaos")
 	{
-		if (!Effects->Confuse)
-			Effects->Chaos = true;
+		if (!ActiveEffects.Confuse)
+			ActiveEffects.Chaos = true;
 	}
 }
 
@@ -430,7 +594,7 @@ Direction VectorDirection(glm::vec2 closet);
 
 void Game::DoCollisions()
 {
-	for (GameObject& box : this->Levels[this->Level].Bricks)
+	for (GameObject& box : this->ActiveLevel().Bricks)
 	{
 		if (!box.Destroyed)
 		{
@@ -442,13 +606,13 @@ void Game::DoCollisions()
 				{
 					box.Destroyed = true;
 					this->SpawnPowerUps(box);
-					SoundEngine->play2D("audios/bleep.mp3", false);
+					PlayAudio("audios/bleep.mp3", false);
 				}
 				else
 				{   // if block is solid, enable shake effect
 					ShakeTime = 0.05f;
-					Effects->Shake = true;
-					SoundEngine->play2D("audios/solid.wav", false);
+					ActiveEffects.Shake = true;
+					PlayAudio("audios/solid.wav", false);
 				}
 				// collision resolution
 				Direction dir = std::get<1>(collision);
@@ -495,7 +659,7 @@ void Game::DoCollisions()
 				ActivatePowerUp(powerUp);
 				powerUp.Destroyed = true;
 				powerUp.Activated = true;
-				SoundEngine->play2D("audios/powerup.wav", false);
+				PlayAudio("audios/powerup.wav", false);
 			}
 		}
 	}
@@ -524,7 +688,7 @@ void Game::DoCollisions()
 		std::cout << "<------------------" << std::endl;*/
 		Ball->Stuck = Ball->Sticky;
 
-		SoundEngine->play2D("audios/bleep.wav", false);
+		PlayAudio("audios/bleep.wav", false);
 	}
 }
 
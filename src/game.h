@@ -3,8 +3,9 @@
 #include <vector>
 #include <tuple>
 
-#include "game_level.h"
+#include "level_manifest.h"
 #include "power_up.h"
+#include "frame_snapshot.h"
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -24,6 +25,8 @@ enum Direction {
 	LEFT
 };
 
+class Renderer;
+
 // Defines a collision typedef that represents collision data
 typedef std::tuple<bool, Direction, glm::vec2> Collision; // <collision?, what direction? difference vector center - closest point>
 
@@ -44,13 +47,15 @@ public:
 	bool KeysProcessed[1024];
 	unsigned int Width, Height;
 
-	std::vector<GameLevel> Levels;
+	LevelManifest Levels;
 	std::vector<PowerUp> PowerUps;
 	unsigned int Level;
 	unsigned int Lives;
 
 	Game(unsigned int width, unsigned int height);
 	~Game();
+	// sets the backend drawing the frames; must be called before Init
+	void SetRenderer(Renderer* renderer);
 	// initialize game state (load all shaders / textures / levels)
 	void Init();
 	// game loop
@@ -58,6 +63,20 @@ public:
 	void Update(float dt);
 	void Render();
 	void DoCollisions();
+	// captures everything needed to draw the current frame (no GL calls)
+	void BuildSnapshot(FrameSnapshot& snapshot);
+	// hands a snapshot to the backend; GL backends must run on the thread owning the context
+	void RenderSnapshot(const FrameSnapshot& snapshot);
+	// window framebuffer changed size (GL thread)
+	void Resize(unsigned int width, unsigned int height);
+	// feeds the CPU time of the last frame to the dynamic resolution controller
+	void ReportFrameTime(float milliseconds);
+	// true while the picture changes on its own (gameplay, effects, particles); otherwise only input changes it
+	bool IsAnimating() const;
+	// reloads shaders, textures and levels when their files change (after Init)
+	void WatchAssets();
+	// the level being played: a level of the manifest, or endless mode for the entry after the last one
+	GameLevel& ActiveLevel();
 
 	// reset
 	void ResetLevel();
@@ -1,43 +1,49 @@
 #include "game_level.h"
 
-#include <fstream>
-#include <sstream>
+#include <iostream>
 
 
 void GameLevel::Load(const char* file, unsigned int levelWidth, unsigned int levelHeight)
 {
 	// clear old data
 	this->Bricks.clear();
+	this->File = file;
 	// load data from file
-	unsigned int tileCode;
-	GameLevel level;
-	std::string line;
-	std::ifstream fstream(file);
-	std::vector<std::vector<unsigned int>> tileData;
+	LevelLayout layout;
+	if (LevelFile::Read(file, layout))
+	{
+		if (layout.Width > MAX_PLAYABLE_LEVEL_SIZE || layout.Height > MAX_PLAYABLE_LEVEL_SIZE)
+			std::cout << "ERROR::LEVEL: " << file << " is " << layout.Width << "x" << layout.Height << ", levels up to "
+				<< MAX_PLAYABLE_LEVEL_SIZE << "x" << MAX_PLAYABLE_LEVEL_SIZE << " can be played" << std::endl;
+		else
+			this->Init(layout, levelWidth, levelHeight);
+	}
+	this->pristine = this->Bricks;
+}
+
+void GameLevel::Reset()
+{
+	this->Bricks = this->pristine;
+}
 
-	if (fstream)
+void GameLevel::Draw(SpriteRenderer& renderer)
+{
+	for (GameObject& tile : this->Bricks)
 	{
-		while (std::getline(fstream, line)) // read each line from level file
+		if (!tile.Destroyed)
 		{
-			std::istringstream sstream(line); 
-			std::vector<unsigned int> row;
-			while (sstream >> tileCode) // read each word separated by space
-				row.push_back(tileCode);
-			tileData.push_back(row);
+			tile.Draw(renderer);
 		}
-
-		if (tileData.size() > 0)
-			this->Init(tileData, levelWidth, levelHeight);
 	}
 }
 
-void GameLevel::Draw(SpriteRenderer& renderer)
+void GameLevel::Draw(RenderQueue& queue)
 {
 	for (GameObject& tile : this->Bricks)
 	{
 		if (!tile.Destroyed)
 		{
-			tile.Draw(renderer);
+			tile.Draw(queue, LAYER_LEVEL);
 		}
 	}
 }
@@ -53,40 +59,49 @@ bool GameLevel::IsCompleted()
 	return true;
 }
 
-void GameLevel::Init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::Init(const LevelLayout& layout, unsigned int levelWidth, unsigned int levelHeight)
 {
-	unsigned int height = tileData.size();
-	unsigned int width = tileData[0].size();
+	unsigned int height = layout.Height;
+	unsigned int width = layout.Width;
 	float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / static_cast<float>(height);
-	// initialize level tiles based on tileData
+	// looked up once, every brick shares them
+	const Texture2D& solidTexture = ResourceManager::GetTexture("block_solid");
+	const Texture2D& blockTexture = ResourceManager::GetTexture("block");
+	// initialize level tiles based on the layout
 	for (unsigned int y = 0; y < height; ++y)
 	{
 		for (unsigned int x = 0; x < width; ++x)
 		{
-			if (tileData[y][x] == 1)
-			{
-				glm::vec2 pos(unit_width * x, unit_height * y);
-				glm::vec2 size(unit_width, unit_height);
-				GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.8f));
-				obj.IsSolid = true;
-				this->Bricks.push_back(obj);
-			}
-			else if (tileData[y][x] > 1)
-			{
-				glm::vec3 color = glm::vec3(1.0f);
-				if (tileData[y][x] == 2)
-					color = glm::vec3(0.2f, 0.6f, 1.0f);
-				else if (tileData[y][x] == 3)
-					color = glm::vec3(0.0f, 0.7f, 0.0f);
-				else if (tileData[y][x] == 4)
-					color = glm::vec3(0.8f, 0.8f, 0.4f);
-				else if (tileData[y][x] == 5)
-					color = glm::vec3(1.0f, 0.5f, 0.0f);
-
-				glm::vec2 pos(unit_width * x, unit_height * y);
-				glm::vec2 size(unit_width, unit_height);
-				this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
-			}
+			glm::vec2 pos(unit_width * x, unit_height * y);
+			glm::vec2 size(unit_width, unit_height);
+			GameObject brick;
+			if (MakeBrick(layout.Tiles[y * width + x], pos, size, solidTexture, blockTexture, brick))
+				this->Bricks.push_back(brick);
 		}
 	}
+}
+
+bool GameLevel::MakeBrick(unsigned int tile, glm::vec2 position, glm::vec2 size, const Texture2D& solidTexture, const Texture2D& blockTexture, GameObject& brick)
+{
+	if (tile == 1)
+	{
+		brick = GameObject(position, size, solidTexture, glm::vec3(0.8f, 0.8f, 0.8f));
+		brick.IsSolid = true;
+		return true;
+	}
+	if (tile > 1)
+	{
+		glm::vec3 color = glm::vec3(1.0f);
+		if (tile == 2)
+			color = glm::vec3(0.2f, 0.6f, 1.0f);
+		else if (tile == 3)
+			color = glm::vec3(0.0f, 0.7f, 0.0f);
+		else if (tile == 4)
+			color = glm::vec3(0.8f, 0.8f, 0.4f);
+		else if (tile == 5)
+			color = glm::vec3(1.0f, 0.5f, 0.0f);
+		brick = GameObject(position, size, blockTexture, color);
+		return true;
+	}
+	return false;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <glad/glad.h>
@@ -8,6 +9,7 @@
 #include "game_object.h"
 #include "sprite_renderer.h"
 #include "resource_manager.h"
+#include "level_file.h"
 
 
 class GameLevel
@@ -15,14 +17,23 @@ class GameLevel
 public:
 	// level state
 	std::vector<GameObject> Bricks;
+	// file the level was loaded from
+	std::string File;
 	// constructor
 	GameLevel(){}
-	// loads level from file
+	// loads level from a binary or text level file (or a generator spec); levels over MAX_PLAYABLE_LEVEL_SIZE stay empty
 	void Load(const char* file, unsigned int levelWidth, unsigned int levelHeight);
+	// restores the bricks as they were loaded, without touching the file
+	void Reset();
 	// render level
 	void Draw(SpriteRenderer& renderer);
+	void Draw(RenderQueue& queue);
 	// check if the level is completed (all non-solid titles are destroyed)
 	bool IsCompleted();
+	// sets up the brick of a tile code (1 solid, 2-5 colored); false for an empty tile
+	static bool MakeBrick(unsigned int tile, glm::vec2 position, glm::vec2 size, const Texture2D& solidTexture, const Texture2D& blockTexture, GameObject& brick);
 private:
-	void Init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
+	// bricks as loaded, copied back by Reset
+	std::vector<GameObject> pristine;
+	void Init(const LevelLayout& layout, unsigned int levelWidth, unsigned int levelHeight);
 };
\ No newline at end of file
@@ -16,4 +16,9 @@ GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec
 void GameObject::Draw(SpriteRenderer& renderer)
 {
 	renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color);
-}
\ No newline at end of file
+}
+
+void GameObject::Draw(RenderQueue& queue, RenderLayer layer)
+{
+	queue.Submit(layer, BLEND_ALPHA, this->Sprite, this->Position, this->Size, this->Rotation, glm::vec4(this->Color, 1.0f));
+}
@@ -5,6 +5,7 @@
 
 #include "texture.h"
 #include "sprite_renderer.h"
+#include "render_queue.h"
 
 
 class GameObject
@@ -25,4 +26,6 @@ public:
 	GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f));
 	// draw sprite
 	virtual void Draw(SpriteRenderer& render);
+	// submit sprite to the render queue
+	virtual void Draw(RenderQueue& queue, RenderLayer layer);
 };
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "gl_renderer.h"
+
+#include <cstdio>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "resource_manager.h"
+
+// section names of the scene layers, indexed by RenderLayer
+const char* LAYER_NAMES[LAYER_COUNT] = { "background", "level", "player", "powerups", "particles", "ball" };
+
+void setSection(GpuSection& section, const GpuTimer& timer, bool active)
+{
+	section.Milliseconds = timer.Milliseconds;
+	section.Latest = timer.Latest;
+	section.Active = active;
+}
+
+GLRenderer::GLRenderer()
+	: Stats(), stream(nullptr), queue(nullptr), effects(nullptr), text(nullptr), gpuTime(0.0f), screenshots(0), width(0), height(0)
+{
+
+}
+
+GLRenderer::~GLRenderer()
+{
+	this->capture.Finish();
+	this->textTimer.Clear();
+	delete this->text;
+	delete this->effects;
+	delete this->queue;
+	delete this->stream;
+}
+
+void GLRenderer::Init(unsigned int width, unsigned int height)
+{
+	this->width = width;
+	this->height = height;
+	// load shaders
+	ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.frag", nullptr, "sprite");
+	ResourceManager::LoadShader("shaders/particle.vs", "shaders/particle.frag", nullptr, "particle");
+	ResourceManager::LoadShader("shaders/sprite_batch.vs", "shaders/sprite_batch.frag", nullptr, "sprite_batch");
+	ResourceManager::LoadShader("shaders/post_processing.vs", "shaders/post_processing.frag", nullptr, "postprocessing");
+	ResourceManager::LoadShader("shaders/post_pass.vs", "shaders/post_blur.frag", nullptr, "post_blur");
+	ResourceManager::LoadShader("shaders/post_pass.vs", "shaders/post_edge.frag", nullptr, "post_edge");
+	ResourceManager::LoadShader("shaders/post_pass.vs", "shaders/post_invert.frag", nullptr, "post_invert");
+	ResourceManager::LoadShader("shaders/post_pass.vs", "shaders/post_bloom.frag", nullptr, "post_bloom");
+	ResourceManager::LoadShader("shaders/post_pass.vs", "shaders/post_crt.frag", nullptr, "post_crt");
+	ResourceManager::LoadShader("shaders/post_pass.vs", "shaders/post_fxaa.frag", nullptr, "post_fxaa");
+	this->configureShaders();
+
+	// set render-specific controls
+	this->stream = new StreamBuffer(4 * 1024 * 1024);
+	this->queue = new RenderQueue(ResourceManager::GetShader("sprite_batch"), this->stream);
+	this->effects = new PostProcessor("postprocessing", width, height);
+	// optional post-processing chain, every pass starts disabled; fxaa is driven by the quality tier
+	this->effects->AddPass("fxaa", ResourceManager::GetShader("post_fxaa"));
+	this->effects->AddPass("blur", ResourceManager::GetShader("post_blur"), 0.5f);
+	this->effects->AddPass("edge", ResourceManager::GetShader("post_edge"));
+	this->effects->AddPass("invert", ResourceManager::GetShader("post_invert"));
+	this->effects->AddPass("bloom", ResourceManager::GetShader("post_bloom"), 0.5f);
+	this->effects->AddPass("crt", ResourceManager::GetShader("post_crt"));
+	this->text = new TextRenderer(width, height, this->stream);
+}
+
+void GLRenderer::LoadFont(std::string font, unsigned int fontSize)
+{
+	this->text->Load(font, fontSize);
+}
+
+void GLRenderer::Render(const FrameSnapshot& snapshot)
+{
+	// apply the renderer configuration requested by the simulation (no-ops if unchanged)
+	this->effects->SetRenderScale(snapshot.Settings.Scale);
+	this->effects->SetSamples(snapshot.Settings.Samples);
+	this->effects->PassScale = snapshot.Settings.PassScale;
+	for (unsigned int i = 0; i < this->effects->Passes.size(); ++i)
+		this->effects->Passes[i].Enabled = (snapshot.Settings.Passes >> i & 1u) != 0;
+	this->effects->Confuse = snapshot.Effects.Confuse;
+	this->effects->Chaos = snapshot.Effects.Chaos;
+	this->effects->Shake = snapshot.Effects.Shake;
+	RenderStats::Current.Reset();
+
+	// every pass has a timer of its own, GL_TIME_ELAPSED queries can't be nested
+	// begin rendering to postprocessing framebuffer
+	this->effects->BeginRender();
+	// draw the scene sorted and batched by state
+	this->queue->Execute(snapshot.Commands);
+	// end rendering to postprocessing framebuffer
+	this->effects->EndRender();
+	// render postprocessing quad
+	this->effects->Render(snapshot.Time);
+	this->updateSections(!snapshot.Commands.empty());
+
+	// rendering text (don't include in postprocessing)
+	this->textTimer.Begin();
+	for (const TextCommand& text : snapshot.Texts)
+		this->text->RenderText(text.Text, text.X, text.Y, text.Scale, text.Color);
+	// capture the finished frame, without the debug overlays
+	bool screenshot = snapshot.Settings.Screenshots != this->screenshots;
+	this->screenshots = snapshot.Settings.Screenshots;
+	if (screenshot || snapshot.Settings.Recording)
+		this->capture.Capture(this->effects->OutputFramebuffer, this->effects->OutputWidth, this->effects->OutputHeight, screenshot, snapshot.Settings.Recording);
+	else
+		this->capture.Poll();
+	if (!snapshot.Settings.Recording)
+		this->capture.StopRecording();
+	// counted before the overlay, whose own text would inflate the figures it shows
+	this->Stats = RenderStats::Current;
+	if (this->log.IsOpen())
+		this->writeLog(snapshot.Frame);
+	if (snapshot.Settings.Overlay || snapshot.Settings.Counters)
+		this->drawOverlay(snapshot.Settings);
+	this->textTimer.End();
+	// the GPU may reuse this frame's stream region once it's done drawing
+	this->stream->EndFrame();
+}
+
+void GLRenderer::Resize(unsigned int width, unsigned int height)
+{
+	this->effects->Resize(width, height);
+}
+
+int GLRenderer::PassIndex(const std::string& name) const
+{
+	return this->effects->PassIndex(name);
+}
+
+float GLRenderer::GpuTime() const
+{
+	return this->gpuTime.load();
+}
+
+void GLRenderer::ReplaceShader(unsigned int previous, const Shader& shader)
+{
+	// uniforms don't carry over to the new program, every holder sets its own again
+	this->configureShaders();
+	this->queue->ReplaceShader(previous, shader);
+	this->effects->ReplaceShader(previous, shader);
+	this->text->ReplaceShader(previous, shader);
+}
+
+void GLRenderer::configureShaders()
+{
+	glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->width),
+		static_cast<float>(this->height), 0.0f, -1.0f, 1.0f);
+	ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
+	ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
+	ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
+	ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
+	ResourceManager::GetShader("sprite_batch").Use().SetInteger("image", 0);
+	ResourceManager::GetShader("sprite_batch").SetMatrix4("projection", projection);
+}
+
+void GLRenderer::SetOutputFramebuffer(unsigned int framebuffer)
+{
+	this->effects->OutputFramebuffer = framebuffer;
+}
+
+bool GLRenderer::SetFrameLog(const std::string& file)
+{
+	return this->log.Open(file);
+}
+
+void GLRenderer::SetCaptureDirectory(const std::string& directory)
+{
+	this->capture.Directory = directory;
+}
+
+void GLRenderer::updateSections(bool scene)
+{
+	// scene layers, resolve, chain passes, final effect pass, text
+	unsigned int count = LAYER_COUNT + this->effects->Passes.size() + 3;
+	if (this->sections.size() != count)
+	{
+		this->sections.resize(count);
+		unsigned int i = 0;
+		for (; i < LAYER_COUNT; ++i)
+			this->sections[i].Name = LAYER_NAMES[i];
+		this->sections[i++].Name = "resolve";
+		for (const PostPass& pass : this->effects->Passes)
+			this->sections[i++].Name = pass.Name;
+		this->sections[i++].Name = "effects";
+		this->sections[i].Name = "text";
+	}
+	// timers of passes that were skipped keep their last reading, the sections are marked inactive instead
+	bool post = !this->effects->Bypassed();
+	unsigned int i = 0;
+	for (; i < LAYER_COUNT; ++i)
+		setSection(this->sections[i], this->queue->LayerTimers[i], scene);
+	setSection(this->sections[i++], this->effects->ResolveTimer, post && this->effects->Samples > 0);
+	for (const PostPass& pass : this->effects->Passes)
+		setSection(this->sections[i++], pass.Timer, post && pass.Enabled);
+	setSection(this->sections[i++], this->effects->EffectTimer, post);
+	setSection(this->sections[i], this->textTimer, true);
+
+	float total = 0.0f;
+	for (const GpuSection& section : this->sections)
+		if (section.Active)
+			total += section.Milliseconds;
+	this->gpuTime = total;
+}
+
+void GLRenderer::drawOverlay(const RenderSettings& settings)
+{
+	const float scale = 0.5f;
+	const float lineHeight = 14.0f;
+	float x = this->width - 160.0f;
+	float y = 10.0f - lineHeight;
+	char line[64];
+	if (settings.Overlay)
+	{
+		std::snprintf(line, sizeof(line), "GPU %.2f ms", this->gpuTime.load());
+		this->text->RenderText(line, x, y += lineHeight, scale, glm::vec3(1.0f, 1.0f, 0.0f));
+		for (const GpuSection& section : this->sections)
+		{
+			if (!section.Active)
+				continue;
+			std::snprintf(line, sizeof(line), "%-10s %6.2f", section.Name.c_str(), section.Milliseconds);
+			this->text->RenderText(line, x, y += lineHeight, scale);
+		}
+	}
+	if (settings.Counters)
+	{
+		// counts of this frame, without the overlay
+		const RenderStats& stats = this->Stats;
+		const unsigned int values[] = { stats.DrawCalls, stats.Vertices, stats.TextureBinds, stats.ProgramSwitches, stats.UniformUploads, stats.BufferUploads, stats.BufferBytes / 1024 };
+		const char* names[] = { "draws", "vertices", "binds", "programs", "uniforms", "uploads", "upload kb" };
+		this->text->RenderText("GL calls", x, y += lineHeight, scale, glm::vec3(1.0f, 1.0f, 0.0f));
+		for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+		{
+			std::snprintf(line, sizeof(line), "%-10s %6u", names[i], values[i]);
+			this->text->RenderText(line, x, y += lineHeight, scale);
+		}
+	}
+}
+
+void GLRenderer::writeLog(unsigned int frame)
+{
+	const unsigned int counters = 7;
+	if (this->columns.size() != this->sections.size() + counters)
+	{
+		this->columns.resize(this->sections.size() + counters);
+		for (unsigned int i = 0; i < this->sections.size(); ++i)
+			this->columns[i].Name = this->sections[i].Name + "_ms";
+		const char* names[counters] = { "draws", "vertices", "texture_binds", "program_switches", "uniform_uploads", "buffer_uploads", "buffer_bytes" };
+		for (unsigned int i = 0; i < counters; ++i)
+			this->columns[this->sections.size() + i].Name = names[i];
+	}
+	// skipped passes are logged as 0
+	for (unsigned int i = 0; i < this->sections.size(); ++i)
+		this->columns[i].Value = this->sections[i].Active ? this->sections[i].Latest : 0.0f;
+	const RenderStats& stats = this->Stats;
+	const unsigned int values[counters] = { stats.DrawCalls, stats.Vertices, stats.TextureBinds, stats.ProgramSwitches, stats.UniformUploads, stats.BufferUploads, stats.BufferBytes };
+	for (unsigned int i = 0; i < counters; ++i)
+		this->columns[this->sections.size() + i].Value = static_cast<float>(values[i]);
+	this->log.Write(frame, this->columns);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "renderer.h"
+#include "stream_buffer.h"
+#include "render_queue.h"
+#include "post_processor.h"
+#include "text_renderer.h"
+#include "gpu_timer.h"
+#include "frame_log.h"
+#include "render_stats.h"
+#include "frame_capture.h"
+
+
+// GPU time of one pass of a frame
+struct GpuSection {
+	std::string Name;
+	float Milliseconds; // smoothed
+	float Latest;       // most recent sample
+	bool Active;        // false if the pass didn't run this frame
+};
+
+// Draws snapshots with OpenGL: the scene through the instanced render queue
+// into the post processor, then the text on top. Every pass (scene layer,
+// resolve, chain pass, final effect pass, text) is timed on the GPU and the
+// GL calls are counted (RenderStats); both can be drawn on top of the frame
+// and logged to a file. Screenshots and recordings are read back
+// asynchronously (FrameCapture).
+class GLRenderer : public Renderer
+{
+public:
+	// GL work of the last frame, without the debug overlays
+	RenderStats Stats;
+	GLRenderer();
+	~GLRenderer();
+	void Init(unsigned int width, unsigned int height) override;
+	void LoadFont(std::string font, unsigned int fontSize) override;
+	void Render(const FrameSnapshot& snapshot) override;
+	void Resize(unsigned int width, unsigned int height) override;
+	int PassIndex(const std::string& name) const override;
+	float GpuTime() const override;
+	void ReplaceShader(unsigned int previous, const Shader& shader) override;
+	// presents into an offscreen framebuffer instead of the window (0 = window)
+	void SetOutputFramebuffer(unsigned int framebuffer);
+	// logs the GPU times and GL counters of every frame to a CSV (or .json) file
+	bool SetFrameLog(const std::string& file);
+	// directory screenshots and recordings are written to
+	void SetCaptureDirectory(const std::string& directory);
+private:
+	// all per-frame vertex data is sub-allocated from one streaming ring
+	StreamBuffer* stream;
+	RenderQueue* queue;
+	PostProcessor* effects;
+	TextRenderer* text;
+	GpuTimer textTimer;
+	// GPU time of the passes, in the order they are drawn
+	std::vector<GpuSection> sections;
+	FrameLog log;
+	std::vector<LogColumn> columns;
+	// total GPU time of a frame, written by whichever thread renders
+	std::atomic<float> gpuTime;
+	FrameCapture capture;
+	// screenshot counter of the last snapshot, a new screenshot is taken whenever it changes
+	unsigned int screenshots;
+	unsigned int width, height;
+	// sets the sampler and projection uniforms of the sprite shaders
+	void configureShaders();
+	// reads the pass timers; scene is false if the frame has no scene commands
+	void updateSections(bool scene);
+	// draws the GPU time breakdown and/or the counters in the top right corner
+	void drawOverlay(const RenderSettings& settings);
+	// appends the frame's GPU times and counters to the log
+	void writeLog(unsigned int frame);
+};
@@ -0,0 +1,60 @@
+#include "gpu_timer.h"
+
+GpuTimer::GpuTimer()
+	: Milliseconds(0.0f), Latest(0.0f), queries(), pending(), index(0), initialized(false), measuring(false), sampled(false)
+{
+
+}
+
+void GpuTimer::Begin()
+{
+	if (!this->initialized)
+	{
+		glGenQueries(LATENCY, this->queries);
+		this->initialized = true;
+	}
+	this->collect();
+	// never reuse a query that hasn't been read back yet, that would stall the pipeline
+	this->measuring = !this->pending[this->index];
+	if (this->measuring)
+		glBeginQuery(GL_TIME_ELAPSED, this->queries[this->index]);
+}
+
+void GpuTimer::End()
+{
+	if (!this->measuring)
+		return;
+	glEndQuery(GL_TIME_ELAPSED);
+	this->pending[this->index] = true;
+	this->index = (this->index + 1) % LATENCY;
+	this->measuring = false;
+}
+
+void GpuTimer::Clear()
+{
+	if (this->initialized)
+		glDeleteQueries(LATENCY, this->queries);
+	this->initialized = false;
+}
+
+void GpuTimer::collect()
+{
+	// walk the slots from oldest to newest so samples are averaged in submission order
+	for (unsigned int i = 0; i < LATENCY; ++i)
+	{
+		unsigned int slot = (this->index + i) % LATENCY;
+		if (!this->pending[slot])
+			continue;
+		int available = 0;
+		glGetQueryObjectiv(this->queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(this->queries[slot], GL_QUERY_RESULT, &elapsed);
+		this->Latest = elapsed / 1000000.0f;
+		// exponential moving average keeps the reading stable yet responsive
+		this->Milliseconds = this->sampled ? this->Milliseconds * 0.9f + this->Latest * 0.1f : this->Latest;
+		this->sampled = true;
+		this->pending[slot] = false;
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glad/glad.h>
+
+
+// GpuTimer measures how long the GPU spends on a range of commands using
+// GL_TIME_ELAPSED queries. Results are read back a few frames later so
+// the CPU never waits on the GPU, and are smoothed over time.
+class GpuTimer
+{
+public:
+	// number of frames a query may stay in flight before its result is read
+	static const unsigned int LATENCY = 4;
+	// smoothed GPU time of the measured range in milliseconds
+	float Milliseconds;
+	// most recent unsmoothed sample in milliseconds
+	float Latest;
+	// constructor
+	GpuTimer();
+	// starts measuring; skipped if the query slot for this frame is still in flight.
+	// GL_TIME_ELAPSED queries can't nest, so only one timer may be measuring at a time
+	void Begin();
+	// stops measuring the range started by Begin
+	void End();
+	// deletes the query objects
+	void Clear();
+private:
+	unsigned int queries[LATENCY];
+	bool pending[LATENCY];
+	unsigned int index;
+	bool initialized, measuring, sampled;
+	// reads back every query whose result is available without blocking
+	void collect();
+};
@@ -0,0 +1,27 @@
+#include "hash.h"
+
+#include <cstdio>
+
+unsigned long long HashBytes(const void* data, size_t size, unsigned long long seed)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	unsigned long long hash = seed;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+unsigned long long HashString(const std::string& text, unsigned long long seed)
+{
+	return HashBytes(text.data(), text.size(), seed);
+}
+
+std::string HashHex(unsigned long long hash)
+{
+	char hex[17];
+	std::snprintf(hex, sizeof(hex), "%016llx", hash);
+	return hex;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+
+// 64-bit FNV-1a; a running hash can be continued by passing it as seed
+const unsigned long long HASH_SEED = 14695981039346656037ull;
+unsigned long long HashBytes(const void* data, size_t size, unsigned long long seed = HASH_SEED);
+unsigned long long HashString(const std::string& text, unsigned long long seed = HASH_SEED);
+// the hash as 16 hex digits, e.g. for file names
+std::string HashHex(unsigned long long hash);
@@ -0,0 +1,135 @@
+#include "headless_context.h"
+
+#include <glad/glad.h>
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "program_cache.h"
+
+
+HeadlessContext::HeadlessContext(unsigned int width, unsigned int height)
+	: FBO(0), ColorBuffer(0), Width(width), Height(height), display(nullptr), context(nullptr)
+{
+
+}
+
+HeadlessContext::~HeadlessContext()
+{
+#ifdef __linux__
+	if (!this->context)
+		return;
+	glDeleteFramebuffers(1, &this->FBO);
+	glDeleteRenderbuffers(1, &this->ColorBuffer);
+	eglMakeCurrent(this->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(this->display, this->context);
+	eglTerminate(this->display);
+#endif
+}
+
+bool HeadlessContext::Init()
+{
+#ifdef __linux__
+	// prefer Mesa's surfaceless platform, it needs neither an X server nor a GPU
+	EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (eglDisplay == EGL_NO_DISPLAY)
+		eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	EGLint major, minor;
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+	{
+		std::cout << "ERROR::HEADLESS: Failed to initialize an EGL display" << std::endl;
+		return false;
+	}
+	this->display = eglDisplay;
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "ERROR::HEADLESS: No EGL config supports desktop OpenGL" << std::endl;
+		return false;
+	}
+	eglBindAPI(EGL_OPENGL_API);
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+	if (eglContext == EGL_NO_CONTEXT)
+	{
+		std::cout << "ERROR::HEADLESS: Failed to create an OpenGL 3.3 core context" << std::endl;
+		return false;
+	}
+	this->context = eglContext;
+	// no surface at all, everything is drawn into the framebuffer below
+	if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+	{
+		std::cout << "ERROR::HEADLESS: Surfaceless contexts are not supported" << std::endl;
+		return false;
+	}
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+	{
+		std::cout << "Failed to initialize GLAD" << std::endl;
+		return false;
+	}
+	ProgramCache::Init((GLADloadproc)eglGetProcAddress);
+
+	// offscreen framebuffer standing in for the window
+	glGenFramebuffers(1, &this->FBO);
+	glGenRenderbuffers(1, &this->ColorBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->ColorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, this->Width, this->Height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->ColorBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "ERROR::HEADLESS: Failed to initialize the offscreen framebuffer" << std::endl;
+		return false;
+	}
+	glViewport(0, 0, this->Width, this->Height);
+	std::cout << "HEADLESS: " << glGetString(GL_RENDERER) << " (EGL " << major << "." << minor << ")" << std::endl;
+	return true;
+#else
+	std::cout << "ERROR::HEADLESS: Headless rendering needs EGL, which is only used on Linux" << std::endl;
+	return false;
+#endif
+}
+
+bool HeadlessContext::SaveFrame(const std::string& file)
+{
+	// the frame is opaque, so the alpha channel is left out
+	unsigned int stride = this->Width * 3;
+	std::vector<unsigned char> pixels(stride * this->Height);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, this->FBO);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, this->Width, this->Height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+	// OpenGL's rows start at the bottom, PNG's at the top; flipped here rather
+	// than with stbi_flip_vertically_on_write, which is global to every writer
+	for (unsigned int y = 0; y < this->Height / 2; ++y)
+		std::swap_ranges(pixels.begin() + y * stride, pixels.begin() + (y + 1) * stride, pixels.begin() + (this->Height - 1 - y) * stride);
+	if (!stbi_write_png(file.c_str(), this->Width, this->Height, 3, pixels.data(), stride))
+	{
+		std::cout << "ERROR::HEADLESS: Failed to write frame: " << file << std::endl;
+		return false;
+	}
+	return true;
+}
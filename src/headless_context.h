@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+
+// Creates an OpenGL 3.3 core context without any window (surfaceless EGL, e.g. Mesa's llvmpipe
+// on machines without a GPU or display) and an offscreen framebuffer the game is rendered into.
+class HeadlessContext
+{
+public:
+	// offscreen framebuffer and its color buffer
+	unsigned int FBO, ColorBuffer;
+	unsigned int Width, Height;
+	// constructor (no GL calls, see Init)
+	HeadlessContext(unsigned int width, unsigned int height);
+	~HeadlessContext();
+	// creates the context, loads the GL functions and allocates the framebuffer; false if not possible
+	bool Init();
+	// waits for the rendering to finish and writes the framebuffer to a PNG file
+	bool SaveFrame(const std::string& file);
+
+private:
+	// EGLDisplay and EGLContext, kept opaque so the EGL headers stay out of this header
+	void* display;
+	void* context;
+};
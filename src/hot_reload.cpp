@@ -0,0 +1,296 @@
+#include "hot_reload.h"
+
+#include <cctype>
+#include <iostream>
+#include <map>
+
+#include <sys/stat.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "renderer.h"
+#include "thread_pool.h"
+
+// how long an idle game keeps redrawing after a change, long enough for the texture uploads
+const std::chrono::milliseconds SETTLE_TIME(1000);
+// how often the watcher checks whether it should stop (and polls without inotify)
+const int WATCH_INTERVAL = 250;
+// what each handler reloads; anything else in the watched directories is ignored, like
+// the binaries converted from the levels and the .tmp files of WriteFileReplacing
+const char* LEVEL_EXTENSIONS[] = { ".lvl" };
+const char* ASSET_EXTENSIONS[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".vs", ".fs", ".vert", ".frag", ".gs", ".geom", ".glsl" };
+
+// whether the file ends in one of the extensions, ignoring case
+template <size_t N>
+bool hasExtension(const std::string& file, const char* (&extensions)[N])
+{
+	size_t dot = file.find_last_of("./\\");
+	if (dot == std::string::npos || file[dot] != '.')
+		return false;
+	std::string extension = file.substr(dot);
+	for (char& c : extension)
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	for (const char* candidate : extensions)
+		if (extension == candidate)
+			return true;
+	return false;
+}
+
+#ifndef __linux__
+// modification times of the files in a directory
+void listFiles(const std::string& directory, std::map<std::string, long long>& times)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find = FindFirstFileA((directory + "/*").c_str(), &data);
+	if (find == INVALID_HANDLE_VALUE)
+		return;
+	do
+	{
+		if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			times[directory + "/" + data.cFileName] = static_cast<long long>(data.ftLastWriteTime.dwHighDateTime) << 32 | data.ftLastWriteTime.dwLowDateTime;
+	} while (FindNextFileA(find, &data));
+	FindClose(find);
+#else
+	DIR* dir = opendir(directory.c_str());
+	if (!dir)
+		return;
+	while (dirent* entry = readdir(dir))
+	{
+		std::string file = directory + "/" + entry->d_name;
+		struct stat info;
+		if (stat(file.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+			times[file] = static_cast<long long>(info.st_mtime);
+	}
+	closedir(dir);
+#endif
+}
+#endif
+
+HotReload::HotReload()
+	: Reloads(0), Failures(0), running(false), worker(nullptr), reading(false), rereadShaders(false)
+{
+
+}
+
+HotReload::~HotReload()
+{
+	this->running = false;
+	if (this->watcher.joinable())
+		this->watcher.join();
+	// lets a reread or level parse in progress finish
+	delete this->worker;
+}
+
+bool HotReload::Start(const std::vector<std::string>& directories)
+{
+	for (const std::string& directory : directories)
+	{
+		struct stat info;
+		if (stat(directory.c_str(), &info) == 0 && (info.st_mode & S_IFDIR))
+			this->directories.push_back(directory);
+		else
+			std::cout << "ERROR::RELOAD: Can't watch " << directory << std::endl;
+	}
+	if (this->directories.empty())
+		return false;
+	this->worker = new ThreadPool(1);
+	this->running = true;
+	this->watcher = std::thread(&HotReload::watch, this);
+	return true;
+}
+
+void HotReload::ApplyAssets(Renderer* renderer)
+{
+	std::set<std::string> files;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		files.swap(this->changedAssets);
+	}
+	for (const std::string& file : files)
+	{
+		bool texture = false;
+		for (unsigned int i = 0; i < ResourceManager::TextureFiles.size(); ++i)
+		{
+			if (ResourceManager::TextureFiles[i] != file)
+				continue;
+			TextureHandle handle;
+			handle.Index = i;
+			ResourceManager::ReloadTexture(handle);
+			texture = true;
+			++this->Reloads;
+			std::cout << "RELOAD: texture " << ResourceManager::TextureNames[i] << std::endl;
+		}
+		// anything else may be a shader or a file one includes; the reread tells
+		if (!texture)
+			this->rereadShaders = true;
+	}
+
+	ShaderCode code;
+	bool ready = false;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->rereadShaders && !this->reading)
+		{
+			// the builds are copied, variants compiled meanwhile are picked up by the next reread
+			this->rereadShaders = false;
+			this->reading = true;
+			std::vector<ShaderBuild> builds = ResourceManager::ShaderBuilds;
+			this->worker->Enqueue([this, builds]() { this->readShaders(builds); });
+		}
+		// one compile per frame; skips sources queued twice by overlapping rereads
+		while (!ready && !this->shaders.empty())
+		{
+			code = this->shaders.front();
+			this->shaders.pop_front();
+			ready = code.Shader.Index < ResourceManager::ShaderBuilds.size() && ResourceManager::ShaderBuilds[code.Shader.Index].Key != code.Key;
+		}
+	}
+	if (!ready)
+		return;
+	unsigned int previous = 0;
+	if (!ResourceManager::ReplaceShader(code, previous))
+	{
+		++this->Failures;
+		return;
+	}
+	renderer->ReplaceShader(previous, ResourceManager::GetShader(code.Shader));
+	++this->Reloads;
+	std::cout << "RELOAD: shader " << ResourceManager::ShaderNames[code.Shader.Index] << std::endl;
+}
+
+void HotReload::ApplyLevels(LevelManifest& levels, unsigned int levelWidth, unsigned int levelHeight)
+{
+	std::set<std::string> files;
+	std::vector<GameLevel> ready;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		files.swap(this->changedLevels);
+		ready.swap(this->levels);
+	}
+	for (const std::string& file : files)
+	{
+		this->worker->Enqueue([this, file, levelWidth, levelHeight]() {
+			// levels are edited as text and played from their binary, which is converted here
+			std::string binary = file.substr(0, file.size() - 4) + ".blvl";
+			GameLevel level;
+			if (LevelFile::Convert(file, binary))
+				level.Load(binary.c_str(), levelWidth, levelHeight);
+			if (level.Bricks.empty())
+			{
+				std::cout << "ERROR::RELOAD: Keeping the previous version of " << file << std::endl;
+				++this->Failures;
+				return;
+			}
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->levels.push_back(level);
+		});
+	}
+	// the level being played restarts from its new layout; levels not in memory are read anew when loaded
+	for (const GameLevel& level : ready)
+	{
+		++this->Reloads;
+		if (levels.Replace(level))
+			std::cout << "RELOAD: level " << level.File << std::endl;
+	}
+}
+
+bool HotReload::Busy()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return !this->changedAssets.empty() || !this->changedLevels.empty() || !this->shaders.empty() || !this->levels.empty() ||
+		this->reading || std::chrono::steady_clock::now() - this->lastChange < SETTLE_TIME;
+}
+
+void HotReload::watch()
+{
+#ifdef __linux__
+	int descriptor = inotify_init1(IN_NONBLOCK);
+	if (descriptor < 0)
+	{
+		std::cout << "ERROR::RELOAD: Failed to initialize inotify" << std::endl;
+		return;
+	}
+	// editors either rewrite a file in place or move a new version over it
+	std::map<int, std::string> watches;
+	for (const std::string& directory : this->directories)
+	{
+		int watch = inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (watch >= 0)
+			watches[watch] = directory;
+	}
+	alignas(inotify_event) char buffer[4096];
+	while (this->running)
+	{
+		pollfd events = { descriptor, POLLIN, 0 };
+		if (poll(&events, 1, WATCH_INTERVAL) <= 0)
+			continue;
+		ssize_t length = read(descriptor, buffer, sizeof(buffer));
+		for (ssize_t offset = 0; offset < length; )
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			auto watch = watches.find(event->wd);
+			if (event->len > 0 && watch != watches.end())
+				this->changed(watch->second + "/" + event->name);
+			offset += sizeof(inotify_event) + event->len;
+		}
+	}
+	close(descriptor);
+#else
+	// no change notifications, the modification times are compared instead
+	std::map<std::string, long long> times;
+	for (const std::string& directory : this->directories)
+		listFiles(directory, times);
+	while (this->running)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_INTERVAL));
+		std::map<std::string, long long> current;
+		for (const std::string& directory : this->directories)
+			listFiles(directory, current);
+		for (auto& file : current)
+		{
+			auto previous = times.find(file.first);
+			if (previous == times.end() || previous->second != file.second)
+				this->changed(file.first);
+		}
+		times.swap(current);
+	}
+#endif
+}
+
+void HotReload::changed(const std::string& file)
+{
+	bool level = hasExtension(file, LEVEL_EXTENSIONS);
+	if (!level && !hasExtension(file, ASSET_EXTENSIONS))
+		return;
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (level)
+		this->changedLevels.insert(file);
+	else
+		this->changedAssets.insert(file);
+	this->lastChange = std::chrono::steady_clock::now();
+}
+
+void HotReload::readShaders(std::vector<ShaderBuild> builds)
+{
+	for (unsigned int i = 0; i < builds.size(); ++i)
+	{
+		ShaderCode code;
+		code.Shader.Index = i;
+		// unchanged sources (the usual case) and unreadable files keep the current program
+		if (!ResourceManager::ReadShader(builds[i], code) || code.Key == builds[i].Key)
+			continue;
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->shaders.push_back(code);
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->reading = false;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "level_manifest.h"
+#include "resource_manager.h"
+
+class Renderer;
+class ThreadPool;
+
+// Watches the asset directories and swaps changed assets in while the game
+// runs. Changes are picked up by a watcher thread (inotify on Linux, file
+// times polled elsewhere); files are read, preprocessed and parsed on a
+// worker thread, and the results swapped in at frame boundaries:
+// - textures are decoded again by the texture loader and uploaded by
+//   ResourceManager::ProcessTextureLoads; a file that fails to load keeps
+//   the current image
+// - shaders whose preprocessed sources changed (includes too) are compiled
+//   one per frame, so a reload never stalls the render loop for more than
+//   one program; a shader that fails to compile keeps the current program
+// - edited text levels (.lvl) are converted to their binary again, loaded
+//   and replace the level played from it if it is resident, unless the new
+//   file has no bricks
+// Other files (the converted .blvl levels, temporaries being written) are
+// ignored, so writing them never triggers a reload.
+class HotReload
+{
+public:
+	// changed assets picked up so far and changed shaders that failed to compile
+	std::atomic<unsigned int> Reloads, Failures;
+	HotReload();
+	~HotReload();
+	// starts watching the given directories (not recursive); false if none can be watched
+	bool Start(const std::vector<std::string>& directories);
+	// swaps in the changed textures and at most one changed shader (GL thread, between frames)
+	void ApplyAssets(Renderer* renderer);
+	// swaps in the reloaded levels that are resident (simulation thread, between updates)
+	void ApplyLevels(LevelManifest& levels, unsigned int levelWidth, unsigned int levelHeight);
+	// true while changes are being applied and for a moment after, so an idle game redraws them
+	bool Busy();
+private:
+	std::thread watcher;
+	std::atomic<bool> running;
+	// reads shader files and parses levels off the frame loop
+	ThreadPool* worker;
+	std::mutex mutex;
+	// changed files not handled yet, by the thread applying them
+	std::set<std::string> changedAssets, changedLevels;
+	// results of the worker, waiting for a frame boundary
+	std::deque<ShaderCode> shaders;
+	std::vector<GameLevel> levels;
+	// a shader reread is running; further changes are picked up by another one once it finishes
+	bool reading;
+	bool rereadShaders;
+	std::chrono::steady_clock::time_point lastChange;
+	std::vector<std::string> directories;
+	// watcher thread: collects changed files until stopped
+	void watch();
+	// sorts a changed file by the thread that applies it, by its extension
+	void changed(const std::string& file);
+	// rereads every shader and queues the ones whose sources changed (worker)
+	void readShaders(std::vector<ShaderBuild> builds);
+};
@@ -0,0 +1,110 @@
+#include "level_file.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "asset_pack.h"
+#include "level_generator.h"
+#include "mapped_file.h"
+
+const char LEVEL_MAGIC[4] = { 'B', 'L', 'V', 'L' };
+const unsigned int LEVEL_VERSION = 1;
+
+bool LevelFile::Read(const std::string& file, LevelLayout& layout)
+{
+	// a generator spec instead of a file
+	LevelSpec spec;
+	if (LevelGenerator::IsSpec(file))
+	{
+		if (!LevelGenerator::Parse(file, spec))
+			return false;
+		LevelGenerator::Generate(spec, layout);
+		return true;
+	}
+	Asset asset;
+	if (!asset.Open(file))
+	{
+		std::cout << "ERROR::LEVEL: Failed to open " << file << std::endl;
+		return false;
+	}
+	if (asset.Size < sizeof(LevelHeader) || std::memcmp(asset.Data, LEVEL_MAGIC, 4) != 0)
+		return parseText(asset.Data, asset.Size, layout);
+
+	LevelHeader header;
+	std::memcpy(&header, asset.Data, sizeof(header));
+	if (header.Version != LEVEL_VERSION || header.Width == 0 || header.Height == 0 ||
+		header.Width > MAX_LEVEL_SIZE || header.Height > MAX_LEVEL_SIZE ||
+		asset.Size != sizeof(header) + header.Width * header.Height)
+	{
+		std::cout << "ERROR::LEVEL: Not a level (or an unsupported version): " << file << std::endl;
+		return false;
+	}
+	layout.Width = header.Width;
+	layout.Height = header.Height;
+	const unsigned char* tiles = asset.Data + sizeof(header);
+	layout.Tiles.assign(tiles, tiles + header.Width * header.Height);
+	return true;
+}
+
+bool LevelFile::Write(const std::string& file, const LevelLayout& layout)
+{
+	LevelHeader header;
+	std::memcpy(header.Magic, LEVEL_MAGIC, 4);
+	header.Version = LEVEL_VERSION;
+	header.Width = layout.Width;
+	header.Height = layout.Height;
+	std::vector<unsigned char> contents(sizeof(header) + layout.Tiles.size());
+	std::memcpy(contents.data(), &header, sizeof(header));
+	std::memcpy(contents.data() + sizeof(header), layout.Tiles.data(), layout.Tiles.size());
+	if (!WriteFileReplacing(file, contents.data(), contents.size()))
+	{
+		std::cout << "ERROR::LEVEL: Failed to write " << file << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool LevelFile::Convert(const std::string& textFile, const std::string& binaryFile)
+{
+	LevelLayout layout;
+	return Read(textFile, layout) && Write(binaryFile, layout);
+}
+
+bool LevelFile::parseText(const unsigned char* data, size_t size, LevelLayout& layout)
+{
+	// codes are collected row by row, then padded into a rectangle
+	std::vector<std::vector<unsigned char>> rows(1);
+	unsigned int code = 0;
+	bool digits = false;
+	for (size_t i = 0; i <= size; ++i)
+	{
+		unsigned char c = i < size ? data[i] : '\n';
+		if (c >= '0' && c <= '9')
+		{
+			code = code * 10 + (c - '0');
+			digits = true;
+			continue;
+		}
+		if (digits)
+			rows.back().push_back(static_cast<unsigned char>(code > 255 ? 255 : code));
+		code = 0;
+		digits = false;
+		if (c == '\n' && !rows.back().empty())
+			rows.emplace_back();
+	}
+	if (rows.back().empty())
+		rows.pop_back();
+	layout.Width = 0;
+	layout.Height = static_cast<unsigned int>(rows.size());
+	for (const std::vector<unsigned char>& row : rows)
+		layout.Width = row.size() > layout.Width ? static_cast<unsigned int>(row.size()) : layout.Width;
+	if (layout.Width == 0 || layout.Width > MAX_LEVEL_SIZE || layout.Height > MAX_LEVEL_SIZE)
+	{
+		std::cout << "ERROR::LEVEL: Empty or oversized level" << std::endl;
+		return false;
+	}
+	layout.Tiles.assign(layout.Width * layout.Height, 0);
+	for (unsigned int y = 0; y < layout.Height; ++y)
+		std::memcpy(&layout.Tiles[y * layout.Width], rows[y].data(), rows[y].size());
+	return true;
+}
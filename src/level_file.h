@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// largest level files can describe, for generated stress data (see LevelGenerator)
+const unsigned int MAX_LEVEL_SIZE = 4096;
+// largest level the game plays: a quarter million bricks, simulated and drawn every frame
+const unsigned int MAX_PLAYABLE_LEVEL_SIZE = 512;
+
+// Header of a binary level (.blvl); the tile codes follow it, one byte
+// per tile, row by row from the top
+struct LevelHeader {
+	char Magic[4]; // "BLVL"
+	unsigned int Version;
+	unsigned int Width, Height;
+};
+
+// Tile codes of a level: 0 is empty, 1 a solid block, 2-5 colored bricks
+struct LevelLayout {
+	unsigned int Width, Height;
+	std::vector<unsigned char> Tiles; // Width * Height, row by row from the top
+};
+
+// Reads and writes level files. Levels ship in the binary format, which
+// is read in place (from the asset pack or the mapped file) and copied as
+// is; the text format (.lvl, rows of space
+// separated codes) is what levels are edited in and is converted with
+// Convert (or --convert-level), but can be read directly as well.
+class LevelFile
+{
+public:
+	// reads a binary or text level, told apart by the header, or generates one from a spec (see LevelGenerator); false if it can't be read or is empty
+	static bool Read(const std::string& file, LevelLayout& layout);
+	// writes a binary level
+	static bool Write(const std::string& file, const LevelLayout& layout);
+	// converts a text level (or a generator spec) into a binary one
+	static bool Convert(const std::string& textFile, const std::string& binaryFile);
+private:
+	LevelFile() { }
+	// parses the rows of a text level; shorter rows are padded with empty tiles
+	static bool parseText(const unsigned char* data, size_t size, LevelLayout& layout);
+};
@@ -0,0 +1,205 @@
+#include "level_generator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+const std::string SPEC_PREFIX = "generate:";
+
+
+Xorshift::Xorshift(unsigned long long seed)
+{
+	this->Seed(seed);
+}
+
+void Xorshift::Seed(unsigned long long seed)
+{
+	// the state must not be zero; the seed is scrambled so nearby seeds start far apart
+	this->state = (seed ^ 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+	if (this->state == 0)
+		this->state = 0x9E3779B97F4A7C15ull;
+}
+
+unsigned long long Xorshift::Next()
+{
+	this->state ^= this->state >> 12;
+	this->state ^= this->state << 25;
+	this->state ^= this->state >> 27;
+	return this->state * 0x2545F4914F6CDD1Dull;
+}
+
+unsigned int Xorshift::Below(unsigned int bound)
+{
+	// the high bits scaled into the range, no division
+	return static_cast<unsigned int>(((this->Next() >> 32) * bound) >> 32);
+}
+
+bool Xorshift::Chance(float probability)
+{
+	return static_cast<float>(this->Next() >> 40) < probability * 16777216.0f;
+}
+
+LevelSpec::LevelSpec()
+	: Pattern(PATTERN_RANDOM), Width(15), Height(8), Density(0.75f), SolidRatio(0.1f), Seed(1)
+{
+
+}
+
+void LevelGenerator::Generate(const LevelSpec& spec, LevelLayout& layout)
+{
+	layout.Width = spec.Width;
+	layout.Height = spec.Height;
+	layout.Tiles.assign(spec.Width * spec.Height, 0);
+	Xorshift random(spec.Seed);
+	if (spec.Pattern == PATTERN_SYMMETRIC)
+		generateSymmetric(spec, random, layout);
+	else if (spec.Pattern == PATTERN_MAZE)
+		generateMaze(spec, random, layout);
+	else
+		scatter(spec, random, layout);
+}
+
+bool LevelGenerator::IsSpec(const std::string& text)
+{
+	return text.compare(0, SPEC_PREFIX.size(), SPEC_PREFIX) == 0;
+}
+
+bool LevelGenerator::Parse(const std::string& text, LevelSpec& spec)
+{
+	spec = LevelSpec();
+	if (!IsSpec(text))
+	{
+		std::cout << "ERROR::LEVEL: Not a level spec: " << text << std::endl;
+		return false;
+	}
+	bool valid = true, sized = false;
+	size_t start = SPEC_PREFIX.size();
+	for (unsigned int field = 0; valid && start <= text.size(); ++field)
+	{
+		size_t end = std::min(text.find(':', start), text.size());
+		std::string value = text.substr(start, end - start);
+		start = end + 1;
+		char* rest = nullptr;
+		if (field == 0)
+		{
+			if (value == "random")
+				spec.Pattern = PATTERN_RANDOM;
+			else if (value == "symmetric")
+				spec.Pattern = PATTERN_SYMMETRIC;
+			else if (value == "maze")
+				spec.Pattern = PATTERN_MAZE;
+			else
+				valid = false;
+		}
+		else if (field == 1)
+		{
+			spec.Width = static_cast<unsigned int>(std::strtoul(value.c_str(), &rest, 10));
+			valid = *rest == 'x';
+			if (valid)
+				spec.Height = static_cast<unsigned int>(std::strtoul(rest + 1, &rest, 10));
+			valid = valid && *rest == '\0';
+			sized = true;
+		}
+		else if (value.compare(0, 8, "density=") == 0)
+			spec.Density = std::strtof(value.c_str() + 8, &rest);
+		else if (value.compare(0, 6, "solid=") == 0)
+			spec.SolidRatio = std::strtof(value.c_str() + 6, &rest);
+		else if (value.compare(0, 5, "seed=") == 0)
+			spec.Seed = std::strtoull(value.c_str() + 5, &rest, 10);
+		else
+			valid = false;
+		valid = valid && (!rest || *rest == '\0');
+	}
+	if (!valid || !sized || spec.Width == 0 || spec.Height == 0 || spec.Width > MAX_LEVEL_SIZE || spec.Height > MAX_LEVEL_SIZE ||
+		!(spec.Density >= 0.0f && spec.Density <= 1.0f) || !(spec.SolidRatio >= 0.0f && spec.SolidRatio <= 1.0f))
+	{
+		std::cout << "ERROR::LEVEL: Malformed level spec (generate:random|symmetric|maze:WxH[:density=D][:solid=S][:seed=N]): " << text << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool LevelGenerator::Benchmark(const std::string& text, unsigned int runs)
+{
+	LevelSpec spec;
+	if (!Parse(text, spec))
+		return false;
+	runs = std::max(1u, runs);
+	LevelLayout layout;
+	float best = 0.0f, total = 0.0f;
+	for (unsigned int run = 0; run < runs; ++run)
+	{
+		// the layout is reused, as a game regenerating levels would
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		Generate(spec, layout);
+		float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		best = run == 0 ? milliseconds : std::min(best, milliseconds);
+		total += milliseconds;
+	}
+	size_t bricks = layout.Tiles.size() - std::count(layout.Tiles.begin(), layout.Tiles.end(), 0);
+	std::cout << "BENCHMARK: " << text << ": " << layout.Width << "x" << layout.Height << " tiles, " << bricks << " bricks, best "
+		<< best << " ms, mean " << total / runs << " ms over " << runs << " runs" << std::endl;
+	return true;
+}
+
+void LevelGenerator::scatter(const LevelSpec& spec, Xorshift& random, LevelLayout& layout)
+{
+	// one draw per tile: its top 24 bits decide whether there is a brick,
+	// the next 24 whether it is solid and the lowest 2 its color
+	unsigned long long density = static_cast<unsigned long long>(spec.Density * 16777216.0f);
+	unsigned long long solid = static_cast<unsigned long long>(spec.SolidRatio * 16777216.0f);
+	for (unsigned char& tile : layout.Tiles)
+	{
+		unsigned long long bits = random.Next();
+		if ((bits >> 40) < density)
+			tile = ((bits >> 16) & 0xFFFFFF) < solid ? 1 : static_cast<unsigned char>(2 + (bits & 3));
+	}
+}
+
+void LevelGenerator::generateSymmetric(const LevelSpec& spec, Xorshift& random, LevelLayout& layout)
+{
+	// a color per row, like the hand-made levels, solid blocks and gaps mirrored
+	unsigned int half = (spec.Width + 1) / 2;
+	for (unsigned int y = 0; y < spec.Height; ++y)
+	{
+		unsigned char color = static_cast<unsigned char>(2 + random.Below(4));
+		unsigned char* row = &layout.Tiles[y * spec.Width];
+		for (unsigned int x = 0; x < half; ++x)
+		{
+			unsigned char tile = 0;
+			if (random.Chance(spec.Density))
+				tile = random.Chance(spec.SolidRatio) ? 1 : color;
+			row[x] = row[spec.Width - 1 - x] = tile;
+		}
+	}
+}
+
+void LevelGenerator::generateMaze(const LevelSpec& spec, Xorshift& random, LevelLayout& layout)
+{
+	// every tile starts as wall, thinned out by the density
+	scatter(spec, random, layout);
+	// the cells sit on odd coordinates; sidewinder carves a perfect maze a
+	// row at a time: runs of cells are joined eastwards, and every run
+	// opens northwards from one of its cells (the top row is one long run)
+	unsigned int cellsWide = (spec.Width - 1) / 2, cellsHigh = (spec.Height - 1) / 2;
+	for (unsigned int cy = 0; cy < cellsHigh; ++cy)
+	{
+		unsigned char* row = &layout.Tiles[(2 * cy + 1) * spec.Width];
+		unsigned char* above = row - spec.Width;
+		unsigned int runStart = 0;
+		for (unsigned int cx = 0; cx < cellsWide; ++cx)
+		{
+			row[2 * cx + 1] = 0;
+			bool last = cx + 1 == cellsWide;
+			if (cy > 0 && (last || random.Below(2) == 0))
+			{
+				unsigned int door = runStart + random.Below(cx - runStart + 1);
+				above[2 * door + 1] = 0;
+				runStart = cx + 1;
+			}
+			else if (!last)
+				row[2 * cx + 2] = 0;
+		}
+	}
+}
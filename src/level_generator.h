@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+
+#include "level_file.h"
+
+
+// xorshift64*: a small, fast generator whose sequence depends only on its
+// seed, so a seed reproduces a level on any platform (unlike std::rand)
+class Xorshift
+{
+public:
+	explicit Xorshift(unsigned long long seed = 1);
+	void Seed(unsigned long long seed);
+	unsigned long long Next();
+	// uniform in [0, bound)
+	unsigned int Below(unsigned int bound);
+	// true with the given probability
+	bool Chance(float probability);
+private:
+	unsigned long long state;
+};
+
+enum LevelPattern {
+	PATTERN_RANDOM,    // tiles scattered independently
+	PATTERN_SYMMETRIC, // the left half mirrored onto the right, as in the hand-made levels
+	PATTERN_MAZE       // brick walls around empty corridors
+};
+
+// What to generate
+struct LevelSpec {
+	LevelPattern Pattern;
+	unsigned int Width, Height;
+	float Density;    // share of the tiles holding a brick (of the walls, for mazes)
+	float SolidRatio; // share of the bricks that are solid
+	unsigned long long Seed;
+	LevelSpec();
+};
+
+// Generates levels from a seed, using the tile codes of LevelLayout. A spec
+// is written "generate:PATTERN:WxH[:density=D][:solid=S][:seed=N]", e.g.
+// "generate:maze:31x15:seed=7"; wherever a level file is expected (the
+// manifest, --convert-level) such a spec generates the level instead.
+class LevelGenerator
+{
+public:
+	// fills the layout; the same spec always produces the same tiles
+	static void Generate(const LevelSpec& spec, LevelLayout& layout);
+	// whether a level file name is a spec
+	static bool IsSpec(const std::string& text);
+	// parses a spec; false (with an error) if it is malformed
+	static bool Parse(const std::string& text, LevelSpec& spec);
+	// generates a spec repeatedly and prints the timings (--benchmark-level)
+	static bool Benchmark(const std::string& text, unsigned int runs);
+private:
+	LevelGenerator() { }
+	// fills the tiles with bricks at random (the random pattern, and the walls of a maze)
+	static void scatter(const LevelSpec& spec, Xorshift& random, LevelLayout& layout);
+	static void generateSymmetric(const LevelSpec& spec, Xorshift& random, LevelLayout& layout);
+	static void generateMaze(const LevelSpec& spec, Xorshift& random, LevelLayout& layout);
+};
@@ -0,0 +1,161 @@
+#include "level_manifest.h"
+
+#include <iostream>
+#include <sstream>
+
+#include "asset_pack.h"
+#include "thread_pool.h"
+
+
+LevelManifest::LevelManifest()
+	: selected(0), levelWidth(0), levelHeight(0), loader(nullptr), prefetching(-1)
+{
+
+}
+
+LevelManifest::~LevelManifest()
+{
+	// lets a prefetch in progress finish before its level is deleted
+	delete this->loader;
+	for (auto& level : this->prefetched)
+		delete level.second;
+	for (GameLevel* level : this->levels)
+		delete level;
+}
+
+bool LevelManifest::Load(const std::string& file, unsigned int levelWidth, unsigned int levelHeight)
+{
+	this->levelWidth = levelWidth;
+	this->levelHeight = levelHeight;
+	Asset asset;
+	if (!asset.Open(file))
+	{
+		std::cout << "ERROR::LEVEL: Failed to open level manifest " << file << std::endl;
+		return false;
+	}
+	std::istringstream manifest(std::string(reinterpret_cast<const char*>(asset.Data), asset.Size));
+	std::string line;
+	while (std::getline(manifest, line))
+	{
+		size_t start = line.find_first_not_of(" \t\r");
+		if (start == std::string::npos || line[start] == '#')
+			continue;
+		size_t end = line.find_first_of(" \t\r", start);
+		LevelEntry entry;
+		entry.File = line.substr(start, end - start);
+		size_t name = end == std::string::npos ? end : line.find_first_not_of(" \t", end);
+		if (name != std::string::npos)
+			entry.Name = line.substr(name, line.find_last_not_of(" \t\r") + 1 - name);
+		this->entries.push_back(entry);
+	}
+	this->levels.assign(this->entries.size(), nullptr);
+	if (this->entries.empty())
+	{
+		std::cout << "ERROR::LEVEL: The level manifest lists no levels: " << file << std::endl;
+		return false;
+	}
+	return true;
+}
+
+unsigned int LevelManifest::Count() const
+{
+	return static_cast<unsigned int>(this->entries.size());
+}
+
+const LevelEntry& LevelManifest::Entry(unsigned int index) const
+{
+	return this->entries[index];
+}
+
+GameLevel& LevelManifest::Get(unsigned int index)
+{
+	static GameLevel empty;
+	if (index >= this->levels.size())
+		return empty;
+	if (!this->levels[index])
+	{
+		// not prefetched (yet), e.g. when stepping back through the menu; a prefetch still running is dropped
+		this->levels[index] = new GameLevel();
+		this->levels[index]->Load(this->entries[index].File.c_str(), this->levelWidth, this->levelHeight);
+	}
+	return *this->levels[index];
+}
+
+void LevelManifest::Select(unsigned int index)
+{
+	// an index past the levels (endless mode) keeps the levels loaded so far
+	if (index >= this->Count())
+		return;
+	this->selected = index;
+	unsigned int next = (index + 1) % this->Count();
+	for (unsigned int i = 0; i < this->levels.size(); ++i)
+		if (i != index && i != next)
+			this->unload(i);
+	this->Get(index);
+	if (this->levels[next] || this->prefetching == static_cast<int>(next))
+		return;
+	if (!this->loader)
+		this->loader = new ThreadPool(1);
+	this->prefetching = next;
+	std::string file = this->entries[next].File;
+	unsigned int width = this->levelWidth, height = this->levelHeight;
+	this->loader->Enqueue([this, next, file, width, height]() {
+		GameLevel* level = new GameLevel();
+		level->Load(file.c_str(), width, height);
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->prefetched.push_back(std::make_pair(next, level));
+	});
+}
+
+void LevelManifest::Update()
+{
+	std::vector<std::pair<unsigned int, GameLevel*>> ready;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (this->prefetched.empty())
+			return;
+		ready.swap(this->prefetched);
+	}
+	unsigned int next = (this->selected + 1) % this->Count();
+	for (auto& level : ready)
+	{
+		if (static_cast<int>(level.first) == this->prefetching)
+			this->prefetching = -1;
+		// loaded meanwhile by Get, or no longer wanted since another level was selected
+		if (this->levels[level.first] || (level.first != this->selected && level.first != next))
+			delete level.second;
+		else
+			this->levels[level.first] = level.second;
+	}
+}
+
+bool LevelManifest::Replace(const GameLevel& level)
+{
+	bool replaced = false;
+	for (unsigned int i = 0; i < this->levels.size(); ++i)
+	{
+		// a level listed by its text file is replaced by the converted binary as well
+		const std::string& file = this->entries[i].File;
+		bool text = file.size() > 4 && file.compare(file.size() - 4, 4, ".lvl") == 0;
+		if (this->levels[i] && (file == level.File || (text && file.substr(0, file.size() - 4) + ".blvl" == level.File)))
+		{
+			*this->levels[i] = level;
+			replaced = true;
+		}
+	}
+	return replaced;
+}
+
+unsigned int LevelManifest::Resident() const
+{
+	unsigned int resident = 0;
+	for (GameLevel* level : this->levels)
+		resident += level != nullptr;
+	return resident;
+}
+
+void LevelManifest::unload(unsigned int index)
+{
+	delete this->levels[index];
+	this->levels[index] = nullptr;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "game_level.h"
+
+class ThreadPool;
+
+// A level listed in the manifest
+struct LevelEntry {
+	std::string File; // binary (or text) level file
+	std::string Name; // shown in the menu
+};
+
+// The levels of the game, listed in a manifest: one level per line, its
+// file followed by its name, '#' starts a comment. Levels are loaded on
+// demand and only the selected level and the one after it stay resident:
+// selecting a level prefetches its successor on a worker thread and
+// unloads every other level, so memory doesn't grow with the number of
+// levels shipped.
+class LevelManifest
+{
+public:
+	LevelManifest();
+	~LevelManifest();
+	// reads the manifest; levels are built for a levelWidth x levelHeight area. False if it lists no levels
+	bool Load(const std::string& file, unsigned int levelWidth, unsigned int levelHeight);
+	unsigned int Count() const;
+	const LevelEntry& Entry(unsigned int index) const;
+	// the level at an index, loaded right away if it isn't resident
+	GameLevel& Get(unsigned int index);
+	// makes a level the current one: prefetches the next level and unloads the others (indices past the last level are ignored)
+	void Select(unsigned int index);
+	// takes over the prefetched levels (call between updates)
+	void Update();
+	// replaces a resident level loaded from the same file, e.g. after a hot reload; false if none is resident
+	bool Replace(const GameLevel& level);
+	// number of levels in memory
+	unsigned int Resident() const;
+private:
+	std::vector<LevelEntry> entries;
+	// loaded levels by index, nullptr if not resident
+	std::vector<GameLevel*> levels;
+	unsigned int selected;
+	unsigned int levelWidth, levelHeight;
+	ThreadPool* loader;
+	// finished prefetches and the level being prefetched (-1 if none)
+	std::mutex mutex;
+	std::vector<std::pair<unsigned int, GameLevel*>> prefetched;
+	int prefetching;
+	void unload(unsigned int index);
+};
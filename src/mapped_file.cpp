@@ -0,0 +1,138 @@
+#include "mapped_file.h"
+
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+void MakeDirectories(const std::string& path)
+{
+	for (size_t slash = path.find('/'); ; slash = path.find('/', slash + 1))
+	{
+		std::string directory = path.substr(0, slash);
+#ifdef _WIN32
+		_mkdir(directory.c_str());
+#else
+		mkdir(directory.c_str(), 0755);
+#endif
+		if (slash == std::string::npos)
+			break;
+	}
+}
+
+bool WriteFileReplacing(const std::string& file, const void* data, size_t size)
+{
+	std::string temporary = file + ".tmp";
+	{
+		std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+		if (!output.write(static_cast<const char*>(data), size) || (output.close(), !output))
+		{
+			std::remove(temporary.c_str());
+			return false;
+		}
+	}
+	// both replace an existing file atomically (rename would fail on Windows)
+#ifdef _WIN32
+	bool moved = MoveFileExA(temporary.c_str(), file.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	bool moved = std::rename(temporary.c_str(), file.c_str()) == 0;
+#endif
+	if (!moved)
+		std::remove(temporary.c_str());
+	return moved;
+}
+
+MappedFile::MappedFile()
+#ifdef _WIN32
+	: Data(nullptr), Size(0), file(INVALID_HANDLE_VALUE), mapping(nullptr)
+#else
+	: Data(nullptr), Size(0), descriptor(-1)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+	this->Close();
+}
+
+bool MappedFile::Open(const std::string& file)
+{
+	this->Close();
+#ifdef _WIN32
+	this->file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (this->file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(this->file, &size) || size.QuadPart == 0)
+	{
+		this->Close();
+		return false;
+	}
+	this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!this->mapping)
+	{
+		this->Close();
+		return false;
+	}
+	this->Data = static_cast<const unsigned char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+	this->Size = static_cast<size_t>(size.QuadPart);
+#else
+	this->descriptor = open(file.c_str(), O_RDONLY);
+	if (this->descriptor < 0)
+		return false;
+	struct stat info;
+	if (fstat(this->descriptor, &info) != 0 || info.st_size == 0)
+	{
+		this->Close();
+		return false;
+	}
+	void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, this->descriptor, 0);
+	this->Data = data != MAP_FAILED ? static_cast<const unsigned char*>(data) : nullptr;
+	this->Size = static_cast<size_t>(info.st_size);
+#endif
+	if (!this->Data)
+	{
+		this->Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (this->Data)
+		UnmapViewOfFile(this->Data);
+	if (this->mapping)
+		CloseHandle(this->mapping);
+	if (this->file != INVALID_HANDLE_VALUE)
+		CloseHandle(this->file);
+	this->file = INVALID_HANDLE_VALUE;
+	this->mapping = nullptr;
+#else
+	if (this->Data)
+		munmap(const_cast<unsigned char*>(this->Data), this->Size);
+	if (this->descriptor >= 0)
+		close(this->descriptor);
+	this->descriptor = -1;
+#endif
+	this->Data = nullptr;
+	this->Size = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return this->Data != nullptr;
+}
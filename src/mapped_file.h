@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+
+// creates every missing directory of a path
+void MakeDirectories(const std::string& path);
+// writes a file under a temporary name and moves it over the old one in a
+// single step, so readers (other runs, a watching game) see either the old
+// or the new contents, never a missing or half written file; false on failure
+bool WriteFileReplacing(const std::string& file, const void* data, size_t size);
+
+// Read-only memory mapping of a whole file. The pages are loaded by the OS
+// on first access, so opening is cheap and unused parts are never read.
+class MappedFile
+{
+public:
+	// mapped contents, nullptr while no file is open
+	const unsigned char* Data;
+	size_t Size;
+	MappedFile();
+	~MappedFile();
+	// maps a file, closing the previous one; false if it can't be opened (or is empty)
+	bool Open(const std::string& file);
+	void Close();
+	bool IsOpen() const;
+private:
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#else
+	int descriptor;
+#endif
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+};
@@ -0,0 +1,31 @@
+#include "null_renderer.h"
+
+#include "resource_manager.h"
+
+
+NullRenderer::NullRenderer()
+	: Frames(0), Commands(0)
+{
+
+}
+
+void NullRenderer::Init(unsigned int /*width*/, unsigned int /*height*/)
+{
+	ResourceManager::UploadTextures = false;
+}
+
+void NullRenderer::LoadFont(std::string /*font*/, unsigned int /*fontSize*/)
+{
+
+}
+
+void NullRenderer::Render(const FrameSnapshot& snapshot)
+{
+	++this->Frames;
+	this->Commands += snapshot.Commands.size();
+}
+
+void NullRenderer::Resize(unsigned int /*width*/, unsigned int /*height*/)
+{
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "renderer.h"
+
+
+// Discards every snapshot, so a run only pays for simulating the game and
+// building its frames. Needs no GL context (textures stay in memory).
+class NullRenderer : public Renderer
+{
+public:
+	// snapshots and scene commands received so far
+	unsigned long long Frames, Commands;
+	NullRenderer();
+	void Init(unsigned int width, unsigned int height) override;
+	void LoadFont(std::string font, unsigned int fontSize) override;
+	void Render(const FrameSnapshot& snapshot) override;
+	void Resize(unsigned int width, unsigned int height) override;
+};
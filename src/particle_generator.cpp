@@ -2,11 +2,15 @@
 #include <iostream>
 
 #include "particle_generator.h"
+#include "render_stats.h"
+
+// stores the index of the last particle used (for quick access to next dead particle)
+unsigned int lastUsedParticle = 0;
 
 ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-	: shader(shader), texture(texture), amount(amount)
+	: particles(amount), amount(amount), shader(shader), texture(texture), VAO(0)
 {
-	this->init();
+	// the GL mesh is only created once the particles are drawn directly
 }
 
 void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset)
@@ -34,6 +38,8 @@ void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newPar
 void ParticleGenerator::Draw()
 {
 	// use additive blending to give it a 'glow' effect
+	if (this->VAO == 0)
+		this->init();
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
 	this->shader.Use();
 	for (Particle particle : this->particles)
@@ -45,6 +51,7 @@ void ParticleGenerator::Draw()
 			this->texture.Bind();
 			glBindVertexArray(this->VAO);
 			glDrawArrays(GL_TRIANGLES, 0, 6);
+			RenderStats::Current.Draw(6);
 			glBindVertexArray(0);
 		}
 	}
@@ -52,6 +59,25 @@ void ParticleGenerator::Draw()
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+void ParticleGenerator::Draw(RenderQueue& queue)
+{
+	// additive blending gives the particles their 'glow' effect
+	for (const Particle& particle : this->particles)
+	{
+		if (particle.Life > 0.0f)
+			queue.Submit(LAYER_PARTICLES, BLEND_ADDITIVE, this->texture, particle.Position, glm::vec2(10.0f), 0.0f, particle.Color);
+	}
+}
+
+void ParticleGenerator::SetAmount(unsigned int amount)
+{
+	this->amount = amount;
+	this->particles.resize(amount);
+	// the spawn cursor may point past the shrunk pool
+	if (lastUsedParticle >= amount)
+		lastUsedParticle = 0;
+}
+
 void ParticleGenerator::init()
 {
 	// set up mesh and attribute properties
@@ -75,14 +101,16 @@ void ParticleGenerator::init()
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
 	glBindVertexArray(0);
+}
 
-	// create this->amount default particle instances
+bool ParticleGenerator::IsAlive() const
+{
 	for (unsigned int i = 0; i < this->amount; ++i)
-		this->particles.push_back(Particle());
+		if (this->particles[i].Life > 0.0f)
+			return true;
+	return false;
 }
 
-// stores the index of the last particle used (for quick access to next dead particle)
-unsigned int lastUsedParticle = 0;
 unsigned int ParticleGenerator::firstUnusedParticle()
 {
 	// first search from last used particle, this will usually return almost instantly
@@ -8,6 +8,7 @@
 #include "shader.h"
 #include "texture.h"
 #include "game_object.h"
+#include "render_queue.h"
 
 // Represents a single particle and its state
 struct Particle {
@@ -30,6 +31,12 @@ public:
 	void Update(float dt, GameObject& object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
 	// render all particles
 	void Draw();
+	// submit all live particles to the render queue
+	void Draw(RenderQueue& queue);
+	// changes the number of particles in the pool
+	void SetAmount(unsigned int amount);
+	// returns true while any particle is alive
+	bool IsAlive() const;
 
 private:
 	// state
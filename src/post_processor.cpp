@@ -1,93 +1,263 @@
 
 #include "post_processor.h"
+#include "resource_manager.h"
+#include "render_stats.h"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
-PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int height)
-	: PostProcessingShader(shader), Texture(), Width(width), Height(height), Confuse(false), Chaos(false), Shake(false)
+// bit flags used to index the effect variants
+enum PostEffect {
+	EFFECT_SHAKE = 1,
+	EFFECT_CONFUSE = 2,
+	EFFECT_CHAOS = 4
+};
+
+PostProcessor::PostProcessor(std::string shaderName, unsigned int width, unsigned int height)
+	: ShaderName(shaderName), Texture(), Width(0), Height(0), OutputWidth(width), OutputHeight(height), RenderScale(1.0f),
+	Samples(4), PassScale(1.0f), OutputFramebuffer(0), Confuse(false), Chaos(false), Shake(false), bypass(false)
 {
 	// initialize renderbuffer/framebuffer object
 	glGenFramebuffers(1, &this->MSFBO);
 	glGenFramebuffers(1, &this->FBO);
 	glGenRenderbuffers(1, &this->RBO);
-	// initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
-	glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);  
-	glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGB, width, height); // allocate storage for render buffer object
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO); // attach MS render buffer object to framebuffer
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
-
-	// also initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
-	glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
-	this->Texture.Generate(width, height, NULL);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0);
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
-	// initiallize render data and uniforms
+	int samples = 0;
+	glGetIntegerv(GL_MAX_SAMPLES, &samples);
+	this->maxSamples = samples;
+	this->Samples = std::min(this->Samples, this->maxSamples);
+	this->allocateTargets();
+	// initiallize render data
 	this->initRenderData();
-	this->PostProcessingShader.SetInteger("scene", 0, true);
-	float offset = 1.0f / 300.0f;
-	float offsets[9][2] = {
-		{ -offset,	offset	}, // top-left
-		{  0.0f,	offset	}, // top-center
-		{  offset,	offset	}, // top-right
-		{ -offset,	0.0f	}, // center-left
-		{  0.0f,	0.0f	}, // center-center
-		{  offset,	0.0f	}, // center-right
-		{ -offset,  -offset	}, // bottom-left
-		{  0.0f,    -offset	}, // bottom-center
-		{  offset,  -offset	},  // bottom-right
-	};
+}
 
-	glUniform2fv(glGetUniformLocation(this->PostProcessingShader.ID, "offsets"), 9, (float*)offsets);
-	int edge_kernel[9] = {
-		-1, -1, -1,
-		-1, 8, -1,
-		-1, -1, -1
-	};
-	glUniform1iv(glGetUniformLocation(this->PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
-	float blur_kernel[9] = {
-		1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f,
-		2.0f / 16.0f, 4.0f / 16.0f, 2.0f / 16.0f,
-		1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f
-	};
-	glUniform1fv(glGetUniformLocation(this->PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);
+void PostProcessor::Resize(unsigned int width, unsigned int height)
+{
+	this->OutputWidth = std::max(1u, width);
+	this->OutputHeight = std::max(1u, height);
+	this->allocateTargets();
+}
+
+void PostProcessor::SetRenderScale(float scale)
+{
+	this->RenderScale = std::min(std::max(scale, 0.1f), 1.0f);
+	this->allocateTargets();
+}
+
+void PostProcessor::SetSamples(unsigned int samples)
+{
+	samples = std::min(samples, this->maxSamples);
+	if (samples == this->Samples)
+		return;
+	this->Samples = samples;
+	this->allocateTargets(true);
 }
 
 void PostProcessor::BeginRender()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+	// without any active effect the offscreen passes would only copy the scene, so render it straight to the screen
+	// (only possible if the scene is rendered at full resolution, otherwise it has to be upscaled)
+	this->bypass = !this->IsActive() && this->Width == this->OutputWidth && this->Height == this->OutputHeight;
+	// without multisampling the scene goes straight into the texture the passes sample
+	glBindFramebuffer(GL_FRAMEBUFFER, this->bypass ? this->OutputFramebuffer : (this->Samples > 0 ? this->MSFBO : this->FBO));
+	glViewport(0, 0, this->Width, this->Height);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void PostProcessor::EndRender()
 {
+	if (this->bypass || this->Samples == 0)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, this->OutputFramebuffer);
+		return;
+	}
 	// now resolve multisampled color-buffer into intermediate FBO to store to texture
 	glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
 	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+	this->ResolveTimer.Begin();
 	glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0); // binds both READ and WRITE framebuffer to default framebuffer
+	this->ResolveTimer.End();
+	glBindFramebuffer(GL_FRAMEBUFFER, this->OutputFramebuffer); // binds both READ and WRITE framebuffer to the output
 }
 
 void PostProcessor::Render(float time)
 {
-	// set uniforms/options
-	this->PostProcessingShader.Use();
-	this->PostProcessingShader.SetFloat("time", time);
-	this->PostProcessingShader.SetInteger("confuse", this->Confuse);
-	this->PostProcessingShader.SetInteger("chaos", this->Chaos);
-	this->PostProcessingShader.SetInteger("shake", this->Shake);
-	// render textured quad
+	if (this->bypass)
+		return;
 	glActiveTexture(GL_TEXTURE0);
-	this->Texture.Bind();
 	glBindVertexArray(this->VAO);
+	// run the enabled chain passes, each one reading the output of the previous
+	Texture2D* source = &this->Texture;
+	for (PostPass& pass : this->Passes)
+	{
+		if (!pass.Enabled)
+			continue;
+		unsigned int width = std::max(1u, static_cast<unsigned int>(this->Width * pass.Scale * this->PassScale));
+		unsigned int height = std::max(1u, static_cast<unsigned int>(this->Height * pass.Scale * this->PassScale));
+		PostTarget& target = this->acquireTarget(width, height);
+		glBindFramebuffer(GL_FRAMEBUFFER, target.FBO);
+		glViewport(0, 0, width, height);
+		pass.Timer.Begin();
+		pass.PassShader.Use();
+		pass.PassShader.SetFloat("time", time);
+		pass.PassShader.SetVector2f("resolution", static_cast<float>(width), static_cast<float>(height));
+		this->setKernelOffsets(pass.PassShader, 1.0f / width, 1.0f / height);
+		source->Bind();
+		glDrawArrays(GL_TRIANGLES, 0, 6);
+		RenderStats::Current.Draw(6);
+		pass.Timer.End();
+		source = &target.Texture;
+	}
+	// the final pass also upscales the scene to the output resolution
+	glBindFramebuffer(GL_FRAMEBUFFER, this->OutputFramebuffer);
+	glViewport(0, 0, this->OutputWidth, this->OutputHeight);
+
+	// set uniforms; the enabled effects are baked into the selected variant
+	this->EffectTimer.Begin();
+	Shader& shader = this->selectShader();
+	shader.Use();
+	shader.SetFloat("time", time);
+	// render textured quad
+	source->Bind();
 	glDrawArrays(GL_TRIANGLES, 0, 6);
+	RenderStats::Current.Draw(6);
+	this->EffectTimer.End();
 	glBindVertexArray(0);
 
 }
 
+bool PostProcessor::IsActive() const
+{
+	if (this->Confuse || this->Chaos || this->Shake)
+		return true;
+	for (const PostPass& pass : this->Passes)
+		if (pass.Enabled)
+			return true;
+	return false;
+}
+
+bool PostProcessor::Bypassed() const
+{
+	return this->bypass;
+}
+
+void PostProcessor::AddPass(std::string name, Shader shader, float scale, bool enabled)
+{
+	PostPass pass;
+	pass.Name = name;
+	pass.PassShader = shader;
+	pass.Scale = scale;
+	pass.Enabled = enabled;
+	this->configureShader(pass.PassShader);
+	this->Passes.push_back(pass);
+}
+
+PostPass* PostProcessor::GetPass(std::string name)
+{
+	for (PostPass& pass : this->Passes)
+		if (pass.Name == name)
+			return &pass;
+	return nullptr;
+}
+
+void PostProcessor::ReplaceShader(unsigned int previous, const Shader& shader)
+{
+	for (PostPass& pass : this->Passes)
+	{
+		if (pass.PassShader.ID == previous)
+		{
+			pass.PassShader = shader;
+			this->configureShader(pass.PassShader);
+		}
+	}
+	for (Shader& variant : this->variants)
+	{
+		if (variant.ID == previous)
+		{
+			variant = shader;
+			this->configureShader(variant);
+		}
+	}
+}
+
+void PostProcessor::allocateTargets(bool force)
+{
+	unsigned int width = std::max(1u, static_cast<unsigned int>(this->OutputWidth * this->RenderScale));
+	unsigned int height = std::max(1u, static_cast<unsigned int>(this->OutputHeight * this->RenderScale));
+	if (!force && width == this->Width && height == this->Height)
+		return;
+	this->Width = width;
+	this->Height = height;
+	// initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
+	// with multisampling off it's unused, so shrink it instead of keeping a full size buffer around
+	glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
+	if (this->Samples > 0)
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->Samples, GL_RGB, width, height); // allocate storage for render buffer object
+	else
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGB8, 1, 1);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO); // attach MS render buffer object to framebuffer
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+
+	// also initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
+	glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+	this->Texture.Generate(width, height, NULL);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// the chain targets depend on the scene size, they are recreated on demand
+	for (auto& iter : this->targets)
+	{
+		for (PostTarget& target : iter.second)
+		{
+			glDeleteFramebuffers(1, &target.FBO);
+			glDeleteTextures(1, &target.Texture.ID);
+		}
+	}
+	this->targets.clear();
+	this->nextTarget.clear();
+}
+
+int PostProcessor::PassIndex(std::string name) const
+{
+	for (unsigned int i = 0; i < this->Passes.size(); ++i)
+		if (this->Passes[i].Name == name)
+			return i;
+	return -1;
+}
+
+PostTarget& PostProcessor::acquireTarget(unsigned int width, unsigned int height)
+{
+	unsigned int key = width << 16 | height;
+	std::vector<PostTarget>& pair = this->targets[key];
+	if (pair.empty())
+	{
+		// lazily create the ping-pong pair the first time a pass runs at this resolution
+		pair.resize(2);
+		for (PostTarget& target : pair)
+		{
+			glGenFramebuffers(1, &target.FBO);
+			glBindFramebuffer(GL_FRAMEBUFFER, target.FBO);
+			// clamp so the convolution passes don't bleed the opposite edge in
+			target.Texture.Wrap_S = GL_CLAMP_TO_EDGE;
+			target.Texture.Wrap_T = GL_CLAMP_TO_EDGE;
+			target.Texture.Generate(width, height, NULL);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.Texture.ID, 0);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+				std::cout << "ERROR::POSTPROCESSOR: Failed to initialize pass target " << width << "x" << height << std::endl;
+		}
+	}
+	// alternate between both targets so a pass never samples the texture it renders into
+	unsigned int& next = this->nextTarget[key];
+	PostTarget& target = pair[next];
+	next = 1 - next;
+	return target;
+}
+
 void PostProcessor::initRenderData()
 {
 	// configure VAO/VBO
@@ -113,4 +283,65 @@ void PostProcessor::initRenderData()
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
-}
\ No newline at end of file
+}
+
+Shader& PostProcessor::selectShader()
+{
+	// chaos overrides confuse in both stages, so they never need to be combined
+	unsigned int flags = 0;
+	if (this->Shake)
+		flags |= EFFECT_SHAKE;
+	if (this->Chaos)
+		flags |= EFFECT_CHAOS;
+	else if (this->Confuse)
+		flags |= EFFECT_CONFUSE;
+
+	Shader& shader = this->variants[flags];
+	if (shader.ID == 0)
+	{
+		std::vector<std::string> defines;
+		if (flags & EFFECT_SHAKE)
+			defines.push_back("SHAKE");
+		if (flags & EFFECT_CONFUSE)
+			defines.push_back("CONFUSE");
+		if (flags & EFFECT_CHAOS)
+			defines.push_back("CHAOS");
+		shader = ResourceManager::GetShaderVariant(this->ShaderName, defines);
+		this->configureShader(shader);
+	}
+	return shader;
+}
+
+void PostProcessor::configureShader(Shader& shader)
+{
+	shader.SetInteger("scene", 0, true);
+	this->setKernelOffsets(shader, 1.0f / 300.0f, 1.0f / 300.0f);
+	float edge_kernel[9] = {
+		-1.0f, -1.0f, -1.0f,
+		-1.0f,  8.0f, -1.0f,
+		-1.0f, -1.0f, -1.0f
+	};
+	glUniform1fv(glGetUniformLocation(shader.ID, "edge_kernel"), 9, edge_kernel);
+	float blur_kernel[9] = {
+		1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f,
+		2.0f / 16.0f, 4.0f / 16.0f, 2.0f / 16.0f,
+		1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f
+	};
+	glUniform1fv(glGetUniformLocation(shader.ID, "blur_kernel"), 9, blur_kernel);
+}
+
+void PostProcessor::setKernelOffsets(Shader& shader, float x, float y)
+{
+	float offsets[9][2] = {
+		{ -x,	y	}, // top-left
+		{  0.0f,	y	}, // top-center
+		{  x,	y	}, // top-right
+		{ -x,	0.0f	}, // center-left
+		{  0.0f,	0.0f	}, // center-center
+		{  x,	0.0f	}, // center-right
+		{ -x,  -y	}, // bottom-left
+		{  0.0f,    -y	}, // bottom-center
+		{  x,  -y	},  // bottom-right
+	};
+	glUniform2fv(glGetUniformLocation(shader.ID, "offsets"), 9, (float*)offsets);
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -7,30 +10,92 @@
 #include "texture.h"
 #include "sprite_renderer.h"
 #include "shader.h"
+#include "gpu_timer.h"
 
 
+// A single fullscreen pass of the post-processing chain
+struct PostPass {
+	std::string Name;
+	Shader PassShader;
+	float Scale;     // resolution of the pass relative to the scene
+	bool Enabled;    // disabled passes are skipped entirely
+	GpuTimer Timer;  // GPU time spent in this pass
+};
+
+// Offscreen color target the chain passes render into
+struct PostTarget {
+	unsigned int FBO;
+	Texture2D Texture;
+};
+
 class PostProcessor
 {
 public:
 	// state
-	Shader PostProcessingShader;
+	std::string ShaderName; // base shader the effect variants are compiled from
 	Texture2D Texture;
-	unsigned int Width, Height;
+	unsigned int Width, Height;             // size the scene is rendered at
+	unsigned int OutputWidth, OutputHeight; // size of the default framebuffer the result is presented to
+	float RenderScale;                      // scene resolution relative to the output
+	unsigned int Samples;                   // MSAA samples of the scene, 0 disables multisampling
+	float PassScale;                        // extra resolution factor applied to every chain pass
+	unsigned int OutputFramebuffer;         // framebuffer the result is presented to (0 = window)
 	// options
 	bool Confuse, Chaos, Shake;
+	// chain of passes run (in order) between the scene and the final effect pass
+	std::vector<PostPass> Passes;
+	// GPU time of the multisample resolve and of the final effect pass
+	GpuTimer ResolveTimer, EffectTimer;
 	// constructor
-	PostProcessor(Shader shader, unsigned int width, unsigned int height);
+	PostProcessor(std::string shaderName, unsigned int width, unsigned int height);
+	// reallocates the render targets for a new output (window framebuffer) size
+	void Resize(unsigned int width, unsigned int height);
+	// renders the scene at a fraction of the output resolution, reallocating the targets if the size changes
+	void SetRenderScale(float scale);
+	// changes the number of MSAA samples (0 = off), clamped to what the driver supports
+	void SetSamples(unsigned int samples);
 	// prepares the postprocessor's framebuffer operations before rendering the game
 	void BeginRender();
 	// should be called after rendering the game, so it stores all the rendered data into a texture object
 	void EndRender();
 	// renders the PostProcessor texture quad (as a screen-encompassing large sprite)
 	void Render(float time);
+	// returns true if any of the effects is enabled and the offscreen passes are required
+	bool IsActive() const;
+	// returns true if the current frame is drawn straight to the output, skipping the resolve and every pass
+	bool Bypassed() const;
+	// appends a pass to the chain; scale sets its resolution relative to the scene
+	void AddPass(std::string name, Shader shader, float scale = 1.0f, bool enabled = false);
+	// returns the pass with the given name or nullptr if there is none
+	PostPass* GetPass(std::string name);
+	// returns the index of the pass with the given name or -1 if there is none
+	int PassIndex(std::string name) const;
+	// switches the passes and variants using a rebuilt shader to the new program
+	void ReplaceShader(unsigned int previous, const Shader& shader);
 private:
 	// render state
 	unsigned int MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
 	unsigned int RBO; // RBO is used for multisampled color buffer
 	unsigned int VAO;
+	// true while the current frame is rendered straight into the default framebuffer
+	bool bypass;
+	// highest MSAA sample count the driver supports
+	unsigned int maxSamples;
+	// specialized shader variants indexed by effect flags, compiled on first use (ID 0 = not compiled yet)
+	Shader variants[8];
+	// ping-pong target pairs per resolution (key = width << 16 | height) and the index to write next
+	std::map<unsigned int, std::vector<PostTarget>> targets;
+	std::map<unsigned int, unsigned int> nextTarget;
 	// initialize quad for rendering postprocessing texture
 	void initRenderData();
-};
\ No newline at end of file
+	// (re)allocates the scene targets at the output size times the render scale
+	void allocateTargets(bool force = false);
+	// returns the shader variant matching the currently enabled effects
+	Shader& selectShader();
+	// sets the constant sampler and kernel uniforms of a freshly compiled variant
+	void configureShader(Shader& shader);
+	// returns the ping-pong target of the given size that wasn't written last
+	PostTarget& acquireTarget(unsigned int width, unsigned int height);
+	// sets the 3x3 sample offsets of a convolution shader
+	void setKernelOffsets(Shader& shader, float x, float y);
+};
@@ -2,23 +2,158 @@
 #include <GLFW/glfw3.h>
 
 #include "game.h"
+#include "gl_renderer.h"
+#include "null_renderer.h"
+#include "recording_renderer.h"
 #include "resource_manager.h"
+#include "render_thread.h"
+#include "headless_context.h"
+#include "software_renderer.h"
+#include "thread_pool.h"
+#include "frame_limiter.h"
+#include "program_cache.h"
+#include "level_file.h"
+#include "level_generator.h"
+#include "asset_pack.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define GLFW_EXPOSE_NATIVE_WIN32
+#include <GLFW/glfw3native.h>
+#endif
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+void window_refresh_callback(GLFWwindow* window);
+// Command line options
+struct RunOptions {
+	bool RenderThread;
+	bool Headless;
+	bool Software;
+	bool NullRenderer;
+	unsigned int Frames;
+	unsigned int DumpEvery;
+	std::string DumpDirectory;
+	std::string RecordFile; // trace of the drawn frames, written while running
+	std::string ReplayFile; // trace to draw instead of playing
+	std::string FrameLogFile; // GPU times and GL counters of every frame (GL only)
+	std::string CaptureDirectory; // where screenshots (F12) and recordings (F10) go
+	int FrameRate; // frame rate limit while playing, -1 = refresh rate of the monitor, 0 = unlimited
+	bool Watch; // reload changed shaders, textures and levels while playing
+	std::string PackFile; // asset pack to load the assets from (loose files if empty)
+	RunOptions() : RenderThread(true), Headless(false), Software(false), NullRenderer(false), Frames(600), DumpEvery(60), FrameRate(-1), Watch(false) { }
+};
+// frame rate limit of windowed runs, 0 = unlimited
+double frame_rate(const RunOptions& options);
+// renders a scripted run (or a recorded trace) without a window and reports the frame rate
+int run_headless(const RunOptions& options);
+// runs the game in a window drawn by the CPU renderer, without any OpenGL
+int run_software(const RunOptions& options);
+// copies the CPU renderer's image into the window
+void present_software(GLFWwindow* window, const SoftwareRenderer& renderer);
 
 // The width of the screen
 const unsigned int SCREEN_WIDTH = 800;
 // The height of the screen
 const unsigned int SCREEN_HEIGHT = 600;
 
+// Upper bound of simulation steps per second while a render thread draws the frames (if the frame rate is unlimited)
+const double SIMULATION_RATE = 240.0;
+// Frame rate of the animations (win screen chaos, fading particles) outside of gameplay
+const double MENU_RATE = 30.0;
+// Longest wait for input while nothing on screen moves; the loop wakes up anyway to notice closed windows etc.
+const double IDLE_TIMEOUT = 0.5;
+
+// Fixed time step of headless runs, so every run simulates (and renders) the same frames
+const float HEADLESS_STEP = 1.0f / 60.0f;
+
+// A key pressed or released at a given frame of a headless run
+struct ScriptedKey {
+	unsigned int Frame;
+	int Key;
+	bool Pressed;
+};
+// starts a game, launches the ball and moves the paddle back and forth
+const ScriptedKey HEADLESS_SCRIPT[] = {
+	{ 10, GLFW_KEY_ENTER, true }, { 11, GLFW_KEY_ENTER, false },
+	{ 30, GLFW_KEY_D, true }, { 60, GLFW_KEY_D, false },
+	{ 60, GLFW_KEY_SPACE, true }, { 61, GLFW_KEY_SPACE, false },
+	{ 90, GLFW_KEY_A, true }, { 150, GLFW_KEY_A, false },
+	{ 150, GLFW_KEY_D, true }, { 270, GLFW_KEY_D, false },
+	{ 270, GLFW_KEY_A, true }, { 330, GLFW_KEY_A, false }
+};
+// the paddle sweeps repeat with this period once the script ran out
+const unsigned int HEADLESS_SCRIPT_LOOP = 240;
+
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
+// set while frames are drawn on a separate render thread
+RenderThread* ActiveRenderThread = nullptr;
+// set while frames are drawn by the CPU renderer
+SoftwareRenderer* SoftwareOutput = nullptr;
+// set by input and window events; a resting picture is only redrawn when this is set
+bool RedrawRequested = true;
 
 int main(int argc, char* argv[])
 {
+	RunOptions options;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--no-render-thread") == 0)
+			options.RenderThread = false;
+		else if (std::strcmp(argv[i], "--headless") == 0)
+			options.Headless = true;
+		else if (std::strcmp(argv[i], "--software") == 0)
+			options.Software = true;
+		else if (std::strcmp(argv[i], "--null-renderer") == 0)
+			options.NullRenderer = true;
+		else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			options.Frames = static_cast<unsigned int>(std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+			options.DumpDirectory = argv[++i];
+		else if (std::strcmp(argv[i], "--dump-every") == 0 && i + 1 < argc)
+			options.DumpEvery = std::max(1, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+			options.RecordFile = argv[++i];
+		else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+			options.ReplayFile = argv[++i];
+		else if (std::strcmp(argv[i], "--frame-log") == 0 && i + 1 < argc)
+			options.FrameLogFile = argv[++i];
+		else if (std::strcmp(argv[i], "--capture-dir") == 0 && i + 1 < argc)
+			options.CaptureDirectory = argv[++i];
+		else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+			options.FrameRate = std::max(0, std::atoi(argv[++i]));
+		else if (std::strcmp(argv[i], "--watch") == 0)
+			options.Watch = true;
+		else if (std::strcmp(argv[i], "--convert-level") == 0 && i + 2 < argc)
+			return LevelFile::Convert(argv[i + 1], argv[i + 2]) ? 0 : 1;
+		else if (std::strcmp(argv[i], "--benchmark-level") == 0 && i + 2 < argc)
+			return LevelGenerator::Benchmark(argv[i + 1], static_cast<unsigned int>(std::atoi(argv[i + 2]))) ? 0 : 1;
+		else if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc)
+			options.PackFile = argv[++i];
+		else if (std::strcmp(argv[i], "--build-pack") == 0 && i + 2 < argc)
+			return AssetPack::Build(argv[i + 1], std::vector<std::string>(argv + i + 2, argv + argc)) ? 0 : 1;
+	}
+	// hot reloading watches the loose files, a pack would hide their changes
+	if (!options.PackFile.empty() && options.Watch)
+		std::cout << "RELOAD: not using the asset pack " << options.PackFile << " while watching the asset files" << std::endl;
+	else if (!options.PackFile.empty() && AssetPack::Open(options.PackFile))
+		std::cout << "LOADING: " << AssetPack::Count() << " assets from " << options.PackFile << std::endl;
+	// the null renderer and replays have nothing to show in a window
+	// (headless runs are never limited, they measure how fast frames can be made)
+	if (options.Headless || options.NullRenderer || !options.ReplayFile.empty())
+		return run_headless(options);
+	if (options.Software)
+		return run_software(options);
+
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -31,6 +166,8 @@ int main(int argc, char* argv[])
 
 	GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breadout", nullptr, nullptr);
 	glfwMakeContextCurrent(window);
+	// an explicit --fps is paced by the frame limiter alone, v-sync would cap it at the refresh rate
+	glfwSwapInterval(options.FrameRate >= 0 ? 0 : 1);
 
 
 	// glad: load all OpenGL function pointers
@@ -39,18 +176,49 @@ int main(int argc, char* argv[])
 		std::cout << "Failed to initialize GLAD" << std::endl;
 		return -1;
 	}
+	ProgramCache::Init((GLADloadproc)glfwGetProcAddress);
 
 	glfwSetKeyCallback(window, key_callback);
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
 	// OpenGL configuration
-	glViewport(0, 0, SCREEN_HEIGHT, SCREEN_HEIGHT);
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	glViewport(0, 0, width, height);
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
 	// initialize game
+	GLRenderer* renderer = new GLRenderer();
+	RecordingRenderer recorder(options.RecordFile, renderer);
+	if (options.RecordFile.empty())
+		Breakout.SetRenderer(renderer);
+	else
+		Breakout.SetRenderer(&recorder);
 	Breakout.Init();
+	Breakout.Resize(width, height);
+	if (options.Watch)
+		Breakout.WatchAssets();
+	if (!options.FrameLogFile.empty())
+		renderer->SetFrameLog(options.FrameLogFile);
+	if (!options.CaptureDirectory.empty())
+		renderer->SetCaptureDirectory(options.CaptureDirectory);
+
+	// hand the GL context to the render thread; from here on this thread only simulates
+	RenderThread thread(window, Breakout);
+	if (options.RenderThread)
+	{
+		ActiveRenderThread = &thread;
+		thread.Start();
+	}
+
+	// frames while playing; with a render thread the simulation never needs to step far more often than frames are shown
+	double playRate = frame_rate(options);
+	if (playRate == 0.0 && options.RenderThread)
+		playRate = SIMULATION_RATE;
+	FrameLimiter limiter;
 
 	// deltaTime variation
 	float deltaTime = 0.0f;
@@ -70,14 +238,40 @@ int main(int argc, char* argv[])
 		// update game state
 		Breakout.Update(deltaTime);
 
-		// render
-		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
-		Breakout.Render();
+		// a picture at rest is drawn once, then the loop sleeps until an event arrives
+		if (!Breakout.IsAnimating() && !RedrawRequested)
+		{
+			glfwWaitEventsTimeout(IDLE_TIMEOUT);
+			// the time spent waiting isn't simulated
+			lastFrame = static_cast<float>(glfwGetTime());
+			limiter.Reset();
+			continue;
+		}
+		RedrawRequested = false;
 
-		glfwSwapBuffers(window);
+		if (ActiveRenderThread)
+		{
+			// publish the frame and move on, the render thread picks up the newest snapshot
+			Breakout.BuildSnapshot(thread.Snapshots.WriteSlot());
+			thread.Snapshots.Publish();
+			float simulationTime = (static_cast<float>(glfwGetTime()) - currentTime) * 1000.0f;
+			Breakout.ReportFrameTime(std::max(simulationTime, thread.FrameTime.load()));
+		}
+		else
+		{
+			// render (the postprocessor clears whichever framebuffer the scene ends up in)
+			Breakout.Render();
+			Breakout.ReportFrameTime((static_cast<float>(glfwGetTime()) - currentTime) * 1000.0f);
+
+			glfwSwapBuffers(window);
+		}
+		limiter.Wait(Breakout.State == GAME_ACTIVE ? playRate : MENU_RATE);
 	}
 
+	// take the GL context back to release the resources
+	thread.Stop();
+	ActiveRenderThread = nullptr;
+	delete renderer;
 	ResourceManager::Clear();
 	glfwTerminate();
 
@@ -86,6 +280,7 @@ int main(int argc, char* argv[])
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
 {
+	RedrawRequested = true;
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
 
@@ -94,11 +289,241 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 		if (action == GLFW_PRESS)
 			Breakout.Keys[key] = true;
 		else if (action == GLFW_RELEASE)
+		{
 			Breakout.Keys[key] = false;
+			Breakout.KeysProcessed[key] = false;
+		}
 	}
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
+	// minimized windows report a zero sized framebuffer
+	if (width <= 0 || height <= 0)
+		return;
+	RedrawRequested = true;
+	// without GL only the CPU framebuffer follows the window
+	if (SoftwareOutput)
+	{
+		Breakout.Resize(width, height);
+		return;
+	}
+	// GL calls have to be made by the thread owning the context
+	if (ActiveRenderThread)
+	{
+		ActiveRenderThread->Resize(width, height);
+		return;
+	}
 	glViewport(0, 0, width, height);
-}
\ No newline at end of file
+	Breakout.Resize(width, height);
+}
+void window_refresh_callback(GLFWwindow* /*window*/)
+{
+	// the window was uncovered or restored and its contents are gone
+	RedrawRequested = true;
+}
+
+double frame_rate(const RunOptions& options)
+{
+	if (options.FrameRate >= 0)
+		return options.FrameRate;
+	const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+	return mode ? mode->refreshRate : 60.0;
+}
+
+// presses/releases the keys the script lists for a frame, the same way key_callback does
+void apply_script(unsigned int frame)
+{
+	const ScriptedKey* last = &HEADLESS_SCRIPT[sizeof(HEADLESS_SCRIPT) / sizeof(HEADLESS_SCRIPT[0]) - 1];
+	// past its end the script replays the paddle sweeps
+	if (frame > last->Frame)
+		frame = last->Frame - HEADLESS_SCRIPT_LOOP + (frame - last->Frame) % HEADLESS_SCRIPT_LOOP;
+	for (const ScriptedKey& event : HEADLESS_SCRIPT)
+	{
+		if (event.Frame != frame)
+			continue;
+		Breakout.Keys[event.Key] = event.Pressed;
+		if (!event.Pressed)
+			Breakout.KeysProcessed[event.Key] = false;
+	}
+}
+
+int run_headless(const RunOptions& options)
+{
+	// only the GL backend needs a context
+	HeadlessContext context(SCREEN_WIDTH, SCREEN_HEIGHT);
+	ThreadPool pool;
+	SoftwareRenderer software(pool);
+	NullRenderer null;
+	GLRenderer* gl = nullptr;
+	Renderer* backend = &null;
+	if (options.Software)
+	{
+		backend = &software;
+	}
+	else if (!options.NullRenderer)
+	{
+		if (!context.Init())
+			return -1;
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		gl = new GLRenderer();
+		backend = gl;
+	}
+	RecordingRenderer recorder(options.RecordFile, backend);
+	Breakout.SetRenderer(options.RecordFile.empty() ? backend : &recorder);
+	Breakout.Init();
+	// every frame of a scripted run has to look the same, so no placeholders
+	ResourceManager::ProcessTextureLoads(true);
+	Breakout.Resize(SCREEN_WIDTH, SCREEN_HEIGHT);
+	if (gl)
+	{
+		gl->SetOutputFramebuffer(context.FBO);
+		if (!options.FrameLogFile.empty())
+			gl->SetFrameLog(options.FrameLogFile);
+	}
+
+	TraceReader trace;
+	bool replay = !options.ReplayFile.empty();
+	if (replay && !trace.Open(options.ReplayFile))
+	{
+		delete gl;
+		return -1;
+	}
+
+	// frame times aren't reported to the game, so the resolution and quality stay fixed and frames comparable
+	FrameSnapshot snapshot;
+	std::chrono::duration<double> renderTime(0.0);
+	unsigned int frames = 0;
+	while (replay ? trace.ReadFrame(snapshot) : frames < options.Frames)
+	{
+		++frames;
+		auto start = std::chrono::steady_clock::now();
+		if (replay)
+		{
+			// a replay only draws, the game isn't simulated
+			Breakout.RenderSnapshot(snapshot);
+		}
+		else
+		{
+			apply_script(frames);
+			Breakout.ProcessInput(HEADLESS_STEP);
+			Breakout.Update(HEADLESS_STEP);
+			Breakout.Render();
+		}
+		// nothing is presented, flushing keeps the driver from queueing up too much work
+		if (gl)
+			glFlush();
+		renderTime += std::chrono::steady_clock::now() - start;
+
+		// dumping frames is not part of the measured time
+		if (!options.DumpDirectory.empty() && frames % options.DumpEvery == 0)
+		{
+			char name[32];
+			std::snprintf(name, sizeof(name), "/frame_%05u.png", frames);
+			if (gl)
+				context.SaveFrame(options.DumpDirectory + name);
+			else if (options.Software)
+				software.SaveFrame(options.DumpDirectory + name);
+		}
+	}
+	if (gl)
+	{
+		auto start = std::chrono::steady_clock::now();
+		glFinish();
+		renderTime += std::chrono::steady_clock::now() - start;
+	}
+
+	double seconds = renderTime.count();
+	std::cout << "HEADLESS: " << frames << " frames in " << seconds << " s ("
+		<< (seconds > 0.0 ? frames / seconds : 0.0) << " fps, "
+		<< (frames > 0 ? seconds * 1000.0 / frames : 0.0) << " ms/frame)" << std::endl;
+	if (backend == &null)
+		std::cout << "HEADLESS: " << (null.Frames > 0 ? null.Commands / null.Frames : 0) << " scene commands per frame" << std::endl;
+
+	// GL objects are released while the context still exists
+	delete gl;
+	ResourceManager::Clear();
+	return 0;
+}
+
+int run_software(const RunOptions& options)
+{
+#ifndef _WIN32
+	(void)options;
+	std::cout << "ERROR::SOFTWARE: Presenting to a window is only implemented on Windows, use --headless --software" << std::endl;
+	return -1;
+#else
+	glfwInit();
+	// no context, the frames are copied into the window with GDI
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breadout", nullptr, nullptr);
+	glfwSetKeyCallback(window, key_callback);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	ThreadPool pool;
+	SoftwareRenderer renderer(pool);
+	RecordingRenderer recorder(options.RecordFile, &renderer);
+	if (options.RecordFile.empty())
+		Breakout.SetRenderer(&renderer);
+	else
+		Breakout.SetRenderer(&recorder);
+	Breakout.Init();
+	if (options.Watch)
+		Breakout.WatchAssets();
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	Breakout.Resize(width, height);
+	SoftwareOutput = &renderer;
+
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
+	double playRate = frame_rate(options);
+	FrameLimiter limiter;
+	float lastFrame = 0.0f;
+	while (!glfwWindowShouldClose(window))
+	{
+		float currentTime = static_cast<float>(glfwGetTime());
+		float deltaTime = currentTime - lastFrame;
+		lastFrame = currentTime;
+		glfwPollEvents();
+
+		Breakout.ProcessInput(deltaTime);
+		Breakout.Update(deltaTime);
+		if (!Breakout.IsAnimating() && !RedrawRequested)
+		{
+			glfwWaitEventsTimeout(IDLE_TIMEOUT);
+			lastFrame = static_cast<float>(glfwGetTime());
+			limiter.Reset();
+			continue;
+		}
+		RedrawRequested = false;
+		Breakout.Render();
+		Breakout.ReportFrameTime((static_cast<float>(glfwGetTime()) - currentTime) * 1000.0f);
+		present_software(window, renderer);
+		limiter.Wait(Breakout.State == GAME_ACTIVE ? playRate : MENU_RATE);
+	}
+
+	SoftwareOutput = nullptr;
+	ResourceManager::Clear();
+	glfwTerminate();
+	return 0;
+#endif
+}
+
+void present_software(GLFWwindow* window, const SoftwareRenderer& renderer)
+{
+#ifdef _WIN32
+	HWND handle = glfwGetWin32Window(window);
+	HDC dc = GetDC(handle);
+	BITMAPINFO info = {};
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = renderer.Width;
+	info.bmiHeader.biHeight = -static_cast<LONG>(renderer.Height); // negative: rows are stored top to bottom
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+	StretchDIBits(dc, 0, 0, renderer.Width, renderer.Height, 0, 0, renderer.Width, renderer.Height,
+		renderer.Pixels.data(), &info, DIB_RGB_COLORS, SRCCOPY);
+	ReleaseDC(handle, dc);
+#endif
+}
@@ -0,0 +1,149 @@
+#include "program_cache.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "hash.h"
+#include "mapped_file.h"
+
+// GL_ARB_get_program_binary, not part of the 3.3 core headers
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRY* GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRY* ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRY* ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+GetProgramBinaryProc getProgramBinary = nullptr;
+ProgramBinaryProc programBinary = nullptr;
+ProgramParameteriProc programParameteri = nullptr;
+
+const char PROGRAM_MAGIC[4] = { 'B', 'P', 'R', 'G' };
+const unsigned int PROGRAM_VERSION = 1;
+
+std::string ProgramCache::Directory = "cache/shaders";
+unsigned int ProgramCache::Hits = 0;
+unsigned int ProgramCache::Misses = 0;
+std::string ProgramCache::driver;
+
+// a GL string, empty if the driver doesn't report it
+std::string glString(GLenum name)
+{
+	const GLubyte* value = glGetString(name);
+	return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+void ProgramCache::Init(GLADloadproc loader)
+{
+	getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(loader("glGetProgramBinary"));
+	programBinary = reinterpret_cast<ProgramBinaryProc>(loader("glProgramBinary"));
+	programParameteri = reinterpret_cast<ProgramParameteriProc>(loader("glProgramParameteri"));
+	// a driver may expose the functions but support no binary format at all
+	GLint formats = 0;
+	if (getProgramBinary && programBinary)
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats <= 0)
+	{
+		getProgramBinary = nullptr;
+		programBinary = nullptr;
+		programParameteri = nullptr;
+		std::cout << "SHADER: program binaries are not supported, compiling every program" << std::endl;
+		return;
+	}
+	driver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+}
+
+bool ProgramCache::Enabled()
+{
+	return getProgramBinary != nullptr;
+}
+
+unsigned long long ProgramCache::Key(const std::string& vertex, const std::string& fragment, const std::string& geometry)
+{
+	// lengths are hashed too, so moving text from one stage to the next changes the key
+	unsigned long long key = HASH_SEED;
+	for (const std::string* source : { &vertex, &fragment, &geometry })
+	{
+		size_t length = source->size();
+		key = HashBytes(&length, sizeof(length), key);
+		key = HashString(*source, key);
+	}
+	return HashString(driver, key);
+}
+
+unsigned int ProgramCache::Load(unsigned long long key)
+{
+	if (!Enabled())
+		return 0;
+	MappedFile file;
+	if (!file.Open(path(key)))
+		return 0;
+	ProgramHeader header;
+	if (file.Size < sizeof(header))
+		return 0;
+	std::memcpy(&header, file.Data, sizeof(header));
+	if (std::memcmp(header.Magic, PROGRAM_MAGIC, 4) != 0 || header.Version != PROGRAM_VERSION ||
+		header.Key != key || header.Length != file.Size - sizeof(header))
+		return 0;
+
+	unsigned int program = glCreateProgram();
+	programBinary(program, header.Format, file.Data + sizeof(header), header.Length);
+	GLint linked = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (!linked)
+	{
+		// rejected (e.g. a driver update that kept the version string), compiled and stored again
+		glDeleteProgram(program);
+		return 0;
+	}
+	++Hits;
+	return program;
+}
+
+void ProgramCache::Store(unsigned long long key, unsigned int program)
+{
+	++Misses;
+	if (!Enabled())
+		return;
+	GLint linked = 0, length = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (!linked || length <= 0)
+		return;
+	// the binary is read in right after the room for its header
+	std::vector<unsigned char> contents(sizeof(ProgramHeader) + length);
+	GLenum format = 0;
+	getProgramBinary(program, length, &length, &format, contents.data() + sizeof(ProgramHeader));
+
+	ProgramHeader header;
+	std::memcpy(header.Magic, PROGRAM_MAGIC, 4);
+	header.Version = PROGRAM_VERSION;
+	header.Key = key;
+	header.Format = format;
+	header.Length = length;
+	std::memcpy(contents.data(), &header, sizeof(header));
+
+	MakeDirectories(Directory);
+	std::string file = path(key);
+	if (!WriteFileReplacing(file, contents.data(), sizeof(header) + length))
+		std::cout << "ERROR::SHADER: Failed to write program cache: " << file << std::endl;
+}
+
+void ProgramCache::HintRetrievable(unsigned int program)
+{
+	if (programParameteri)
+		programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+std::string ProgramCache::path(unsigned long long key)
+{
+	return Directory + "/" + HashHex(key) + ".bin";
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+
+#include <glad/glad.h>
+
+
+// Header of a cached program binary (.bin); the driver's binary follows it
+struct ProgramHeader {
+	char Magic[4];          // "BPRG"
+	unsigned int Version;
+	unsigned long long Key; // see ProgramCache::Key
+	unsigned int Format;    // binary format reported by the driver
+	unsigned int Length;
+};
+
+// ProgramCache keeps linked shader programs on disk (glGetProgramBinary),
+// so later launches restore them with glProgramBinary instead of compiling
+// and linking. Entries are keyed by the preprocessed sources and the
+// driver's vendor, renderer and version; a driver update simply misses.
+// Drivers may still reject a binary, in which case Load fails and the
+// program is compiled and stored again. Program binaries are core in GL 4.1
+// only, so the entry points are loaded by hand and the cache stays off on
+// contexts without them.
+class ProgramCache
+{
+public:
+	// where the binaries are kept
+	static std::string Directory;
+	// programs restored from the cache and programs that had to be compiled
+	static unsigned int Hits, Misses;
+	// loads the program binary functions; call with a current context after GLAD is loaded
+	static void Init(GLADloadproc loader);
+	static bool Enabled();
+	// cache key of a program's sources on the current driver
+	static unsigned long long Key(const std::string& vertex, const std::string& fragment, const std::string& geometry);
+	// creates a program from its cached binary, 0 if there is none or the driver rejects it
+	static unsigned int Load(unsigned long long key);
+	// writes a linked program's binary
+	static void Store(unsigned long long key, unsigned int program);
+	// asks the driver to keep the binary of a program about to be linked retrievable
+	static void HintRetrievable(unsigned int program);
+private:
+	ProgramCache() { }
+	// vendor, renderer and version strings of the driver the binaries are for
+	static std::string driver;
+	static std::string path(unsigned long long key);
+};
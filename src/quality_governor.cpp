@@ -0,0 +1,80 @@
+#include "quality_governor.h"
+
+#include <algorithm>
+
+// number of frames in the rolling window
+const unsigned int GOVERNOR_WINDOW = 120;
+// percentile of the window that is compared against the budget
+const float GOVERNOR_PERCENTILE = 0.95f;
+// fraction of the budget the percentile has to stay below before stepping up
+const float GOVERNOR_HEADROOM = 0.6f;
+// upper bound for the upgrade delay after repeated oscillation
+const unsigned int GOVERNOR_MAX_DELAY = GOVERNOR_WINDOW * 32;
+
+QualityGovernor::QualityGovernor(float budget)
+	: Tier(0), Budget(budget), samples(GOVERNOR_WINDOW, 0.0f), next(0), count(0),
+	upgradeDelay(GOVERNOR_WINDOW * 2), framesWithHeadroom(0), lastUpgrade(-1)
+{
+	this->Tiers.push_back({ "low",    100, 1, 0, false, 0.25f });
+	this->Tiers.push_back({ "medium", 250, 1, 0, true,  0.5f });
+	this->Tiers.push_back({ "high",   500, 2, 2, false, 0.5f });
+	this->Tiers.push_back({ "ultra",  500, 2, 4, false, 1.0f });
+	this->Tier = this->Tiers.size() - 1;
+}
+
+bool QualityGovernor::Update(float frameTime, bool allowDown, bool allowUp)
+{
+	this->samples[this->next] = frameTime;
+	this->next = (this->next + 1) % GOVERNOR_WINDOW;
+	this->count = std::min(this->count + 1, GOVERNOR_WINDOW);
+	// wait for a full window of samples taken at the current tier
+	if (this->count < GOVERNOR_WINDOW)
+		return false;
+
+	float percentile = this->Percentile(GOVERNOR_PERCENTILE);
+	if (percentile > this->Budget)
+	{
+		this->framesWithHeadroom = 0;
+		if (!allowDown || this->Tier == 0)
+			return false;
+		// the tier we just stepped up to can't be held; back off for longer next time
+		if (static_cast<int>(this->Tier) == this->lastUpgrade)
+			this->upgradeDelay = std::min(this->upgradeDelay * 2, GOVERNOR_MAX_DELAY);
+		this->setTier(this->Tier - 1);
+		return true;
+	}
+
+	if (percentile < this->Budget * GOVERNOR_HEADROOM)
+		++this->framesWithHeadroom;
+	else
+		this->framesWithHeadroom = 0;
+	if (!allowUp || this->Tier + 1 >= this->Tiers.size() || this->framesWithHeadroom < this->upgradeDelay)
+		return false;
+	this->setTier(this->Tier + 1);
+	this->lastUpgrade = this->Tier;
+	return true;
+}
+
+const QualityTier& QualityGovernor::Current() const
+{
+	return this->Tiers[this->Tier];
+}
+
+float QualityGovernor::Percentile(float fraction) const
+{
+	if (this->count == 0)
+		return 0.0f;
+	std::vector<float> sorted(this->samples.begin(), this->samples.begin() + this->count);
+	unsigned int rank = std::min(this->count - 1, static_cast<unsigned int>(fraction * this->count));
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+	return sorted[rank];
+}
+
+void QualityGovernor::setTier(unsigned int tier)
+{
+	this->Tier = tier;
+	// frame times measured at the old tier say nothing about the new one
+	this->count = 0;
+	this->next = 0;
+	this->framesWithHeadroom = 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+// One step of the quality ladder
+struct QualityTier {
+	std::string Name;
+	unsigned int Particles;         // size of the particle pool
+	unsigned int ParticlesPerFrame; // density of the ball's particle trail
+	unsigned int Samples;           // MSAA samples of the scene, 0 = off
+	bool Fxaa;                      // post-process anti-aliasing (used when MSAA is off)
+	float PassScale;                // resolution of the post-processing chain passes
+};
+
+// QualityGovernor watches a rolling percentile of the frame time and steps
+// a ladder of quality tiers down when frames go over budget and up again
+// when there's plenty of headroom. Upgrades that immediately have to be
+// undone make the next upgrade wait twice as long, so it settles on the
+// highest tier the machine can actually sustain instead of oscillating.
+class QualityGovernor
+{
+public:
+	// tiers ordered from lowest to highest quality
+	std::vector<QualityTier> Tiers;
+	// index of the tier currently in use
+	unsigned int Tier;
+	// frame time (in milliseconds) the governor tries to stay under
+	float Budget;
+	// constructor, starts at the highest tier
+	QualityGovernor(float budget = 1000.0f / 60.0f);
+	// feeds the frame time of the last frame; the caller can veto stepping in either
+	// direction (e.g. while a finer grained controller still has room). Returns true if the tier changed
+	bool Update(float frameTime, bool allowDown = true, bool allowUp = true);
+	// the tier currently in use
+	const QualityTier& Current() const;
+	// frame time percentile over the current window
+	float Percentile(float fraction) const;
+private:
+	// ring buffer of the most recent frame times
+	std::vector<float> samples;
+	unsigned int next, count;
+	// frames the frame time has to stay low before stepping up
+	unsigned int upgradeDelay, framesWithHeadroom;
+	// tier that was most recently stepped up to, to detect oscillation
+	int lastUpgrade;
+	void setTier(unsigned int tier);
+};
@@ -0,0 +1,284 @@
+#include "recording_renderer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "resource_manager.h"
+#include "render_queue.h"
+
+const char TRACE_MAGIC[4] = { 'B', 'K', 'T', 'R' };
+const unsigned int TRACE_VERSION = 1;
+// colors are stored as 16-bit fixed point with 1.0 = 0x4000, enough for the tints above 1 the particles use
+const float COLOR_SCALE = 16384.0f;
+
+// appends the bytes of a value to the buffer
+template <typename T>
+void write(std::vector<unsigned char>& buffer, T value)
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void writeColor(std::vector<unsigned char>& buffer, float value)
+{
+	write<unsigned short>(buffer, static_cast<unsigned short>(std::max(0.0f, std::min(65535.0f, value * COLOR_SCALE + 0.5f))));
+}
+
+void writeString(std::vector<unsigned char>& buffer, const std::string& value)
+{
+	write<unsigned short>(buffer, static_cast<unsigned short>(value.size()));
+	buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+template <typename T>
+bool read(std::ifstream& stream, T& value)
+{
+	return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+float readColor(std::ifstream& stream)
+{
+	unsigned short value = 0;
+	read(stream, value);
+	return value / COLOR_SCALE;
+}
+
+bool readString(std::ifstream& stream, std::string& value)
+{
+	unsigned short length = 0;
+	if (!read(stream, length))
+		return false;
+	value.resize(length);
+	return length == 0 || static_cast<bool>(stream.read(&value[0], length));
+}
+
+RecordingRenderer::RecordingRenderer(const std::string& file, Renderer* inner)
+	: Bytes(0), file(file), inner(inner)
+{
+
+}
+
+RecordingRenderer::~RecordingRenderer()
+{
+	if (this->stream.is_open())
+		std::cout << "TRACE: wrote " << this->Bytes << " bytes to " << this->file << std::endl;
+}
+
+void RecordingRenderer::Init(unsigned int width, unsigned int height)
+{
+	if (this->inner)
+		this->inner->Init(width, height);
+	else
+		ResourceManager::UploadTextures = false;
+	this->stream.open(this->file, std::ios::binary | std::ios::trunc);
+	if (!this->stream)
+	{
+		std::cout << "ERROR::TRACE: Failed to open trace file: " << this->file << std::endl;
+		return;
+	}
+	this->buffer.clear();
+	this->buffer.insert(this->buffer.end(), TRACE_MAGIC, TRACE_MAGIC + 4);
+	write(this->buffer, TRACE_VERSION);
+	write(this->buffer, width);
+	write(this->buffer, height);
+	this->stream.write(reinterpret_cast<const char*>(this->buffer.data()), this->buffer.size());
+	this->Bytes += this->buffer.size();
+}
+
+void RecordingRenderer::LoadFont(std::string font, unsigned int fontSize)
+{
+	if (this->inner)
+		this->inner->LoadFont(font, fontSize);
+}
+
+void RecordingRenderer::Render(const FrameSnapshot& snapshot)
+{
+	if (this->stream.is_open())
+	{
+		// texture chunks first, so the reader knows every index once it reaches the frame
+		this->buffer.clear();
+		std::vector<unsigned short> indices(snapshot.Commands.size());
+		for (unsigned int i = 0; i < snapshot.Commands.size(); ++i)
+			indices[i] = this->textureIndex(snapshot.Commands[i].Texture);
+
+		write<unsigned char>(this->buffer, 'F');
+		write(this->buffer, snapshot.Frame);
+		write(this->buffer, snapshot.Time);
+		write<unsigned char>(this->buffer, snapshot.Effects.Confuse | snapshot.Effects.Chaos << 1 | snapshot.Effects.Shake << 2);
+		write(this->buffer, snapshot.Settings.Scale);
+		write(this->buffer, snapshot.Settings.Samples);
+		write(this->buffer, snapshot.Settings.PassScale);
+		write(this->buffer, snapshot.Settings.Passes);
+		write<unsigned int>(this->buffer, snapshot.Commands.size());
+		for (unsigned int i = 0; i < snapshot.Commands.size(); ++i)
+		{
+			const RenderCommand& command = snapshot.Commands[i];
+			write<unsigned char>(this->buffer, RenderQueue::KeyLayer(command.Key));
+			write<unsigned char>(this->buffer, RenderQueue::KeyBlend(command.Key));
+			write(this->buffer, indices[i]);
+			write(this->buffer, command.Position.x);
+			write(this->buffer, command.Position.y);
+			write(this->buffer, command.Size.x);
+			write(this->buffer, command.Size.y);
+			write(this->buffer, command.Rotation);
+			for (int c = 0; c < 4; ++c)
+				writeColor(this->buffer, command.Color[c]);
+		}
+		write<unsigned int>(this->buffer, snapshot.Texts.size());
+		for (const TextCommand& text : snapshot.Texts)
+		{
+			write(this->buffer, text.X);
+			write(this->buffer, text.Y);
+			write(this->buffer, text.Scale);
+			for (int c = 0; c < 3; ++c)
+				writeColor(this->buffer, text.Color[c]);
+			writeString(this->buffer, text.Text);
+		}
+		this->stream.write(reinterpret_cast<const char*>(this->buffer.data()), this->buffer.size());
+		this->Bytes += this->buffer.size();
+	}
+	if (this->inner)
+		this->inner->Render(snapshot);
+}
+
+void RecordingRenderer::Resize(unsigned int width, unsigned int height)
+{
+	if (this->inner)
+		this->inner->Resize(width, height);
+}
+
+int RecordingRenderer::PassIndex(const std::string& name) const
+{
+	return this->inner ? this->inner->PassIndex(name) : -1;
+}
+
+float RecordingRenderer::GpuTime() const
+{
+	return this->inner ? this->inner->GpuTime() : 0.0f;
+}
+
+void RecordingRenderer::ReplaceShader(unsigned int previous, const Shader& shader)
+{
+	if (this->inner)
+		this->inner->ReplaceShader(previous, shader);
+}
+
+unsigned short RecordingRenderer::textureIndex(unsigned int texture)
+{
+	auto iter = this->textures.find(texture);
+	if (iter != this->textures.end())
+		return iter->second;
+	// first use: name the texture in a chunk of its own
+	std::string name;
+	for (unsigned int i = 0; i < ResourceManager::Textures.size(); ++i)
+		if (ResourceManager::Textures[i].ID == texture)
+			name = ResourceManager::TextureNames[i];
+	unsigned short index = static_cast<unsigned short>(this->textures.size());
+	this->textures[texture] = index;
+	std::vector<unsigned char> chunk;
+	write<unsigned char>(chunk, 'T');
+	write(chunk, index);
+	writeString(chunk, name);
+	this->stream.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+	this->Bytes += chunk.size();
+	return index;
+}
+
+TraceReader::TraceReader()
+	: Width(0), Height(0)
+{
+
+}
+
+bool TraceReader::Open(const std::string& file)
+{
+	this->stream.open(file, std::ios::binary);
+	char magic[4];
+	unsigned int version = 0;
+	if (!this->stream || !this->stream.read(magic, 4) || std::memcmp(magic, TRACE_MAGIC, 4) != 0 ||
+		!read(this->stream, version) || version != TRACE_VERSION ||
+		!read(this->stream, this->Width) || !read(this->stream, this->Height))
+	{
+		std::cout << "ERROR::TRACE: Not a trace (or an unsupported version): " << file << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool TraceReader::ReadFrame(FrameSnapshot& snapshot)
+{
+	unsigned int shader = ResourceManager::GetShader("sprite_batch").ID;
+	unsigned char type;
+	while (read(this->stream, type))
+	{
+		if (type == 'T')
+		{
+			unsigned short index;
+			std::string name;
+			if (!read(this->stream, index) || !readString(this->stream, name))
+				break;
+			if (index >= this->textures.size())
+				this->textures.resize(index + 1, 0);
+			this->textures[index] = ResourceManager::GetTexture(name).ID;
+			continue;
+		}
+		if (type != 'F')
+		{
+			std::cout << "ERROR::TRACE: Unknown chunk type " << static_cast<int>(type) << std::endl;
+			return false;
+		}
+		unsigned char effects = 0;
+		unsigned int count = 0;
+		read(this->stream, snapshot.Frame);
+		read(this->stream, snapshot.Time);
+		read(this->stream, effects);
+		snapshot.Effects = { (effects & 1) != 0, (effects & 2) != 0, (effects & 4) != 0 };
+		read(this->stream, snapshot.Settings.Scale);
+		read(this->stream, snapshot.Settings.Samples);
+		read(this->stream, snapshot.Settings.PassScale);
+		read(this->stream, snapshot.Settings.Passes);
+		snapshot.Settings.Overlay = false;
+		snapshot.Settings.Counters = false;
+		snapshot.Settings.Screenshots = 0;
+		snapshot.Settings.Recording = false;
+		read(this->stream, count);
+		snapshot.Commands.resize(count);
+		for (RenderCommand& command : snapshot.Commands)
+		{
+			unsigned char layer = 0, blend = 0;
+			unsigned short index = 0;
+			read(this->stream, layer);
+			read(this->stream, blend);
+			read(this->stream, index);
+			read(this->stream, command.Position.x);
+			read(this->stream, command.Position.y);
+			read(this->stream, command.Size.x);
+			read(this->stream, command.Size.y);
+			read(this->stream, command.Rotation);
+			for (int c = 0; c < 4; ++c)
+				command.Color[c] = readColor(this->stream);
+			command.Texture = index < this->textures.size() ? this->textures[index] : 0;
+			command.Key = RenderQueue::MakeKey(static_cast<RenderLayer>(layer), static_cast<BlendMode>(blend), shader, command.Texture);
+		}
+		count = 0;
+		read(this->stream, count);
+		snapshot.Texts.resize(count);
+		for (TextCommand& text : snapshot.Texts)
+		{
+			read(this->stream, text.X);
+			read(this->stream, text.Y);
+			read(this->stream, text.Scale);
+			for (int c = 0; c < 3; ++c)
+				text.Color[c] = readColor(this->stream);
+			readString(this->stream, text.Text);
+		}
+		if (!this->stream)
+		{
+			std::cout << "ERROR::TRACE: Trace ends in the middle of a frame" << std::endl;
+			return false;
+		}
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "renderer.h"
+
+
+// Writes every snapshot to a binary trace, optionally passing it on to
+// another backend. A trace is a header ("BKTR", version, scene size)
+// followed by chunks: 'T' maps a trace texture index to a texture name and
+// precedes the first frame using it, 'F' holds a frame's settings, scene
+// commands (32 bytes each) and texts. Replaying a trace (TraceReader) times
+// a backend without simulating, so submission and GPU cost can be told apart.
+class RecordingRenderer : public Renderer
+{
+public:
+	// bytes written so far
+	unsigned long long Bytes;
+	// constructor; without an inner backend nothing is drawn (and no GL context is needed)
+	RecordingRenderer(const std::string& file, Renderer* inner = nullptr);
+	~RecordingRenderer();
+	void Init(unsigned int width, unsigned int height) override;
+	void LoadFont(std::string font, unsigned int fontSize) override;
+	void Render(const FrameSnapshot& snapshot) override;
+	void Resize(unsigned int width, unsigned int height) override;
+	int PassIndex(const std::string& name) const override;
+	float GpuTime() const override;
+	void ReplaceShader(unsigned int previous, const Shader& shader) override;
+private:
+	std::string file;
+	std::ofstream stream;
+	Renderer* inner;
+	// GL/software texture ID to trace texture index
+	std::map<unsigned int, unsigned short> textures;
+	// bytes of the chunks of the current frame, written at once
+	std::vector<unsigned char> buffer;
+	unsigned short textureIndex(unsigned int texture);
+};
+
+// Reads the frames of a trace written by RecordingRenderer. Textures are
+// resolved by name against the textures currently loaded in ResourceManager.
+class TraceReader
+{
+public:
+	// scene size the trace was recorded with
+	unsigned int Width, Height;
+	TraceReader();
+	// opens a trace and checks its header
+	bool Open(const std::string& file);
+	// reads the next frame, false at the end of the trace
+	bool ReadFrame(FrameSnapshot& snapshot);
+private:
+	std::ifstream stream;
+	// trace texture index to loaded texture ID
+	std::vector<unsigned int> textures;
+};
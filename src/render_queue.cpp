@@ -0,0 +1,206 @@
+#include "render_queue.h"
+#include "render_stats.h"
+
+#include <algorithm>
+#include <cstddef>
+
+// bit offsets of the sort key fields
+const unsigned int KEY_LAYER_SHIFT = 56;
+const unsigned int KEY_BLEND_SHIFT = 48;
+const unsigned int KEY_SHADER_SHIFT = 32;
+
+RenderQueue::RenderQueue(Shader shader, StreamBuffer* stream)
+	: Commands(0), Batches(0), shader(shader), stream(stream), VAO(0), quadVBO(0)
+{
+	// GL objects are created on the first Execute, a queue that is only sorted never touches GL
+}
+
+RenderQueue::~RenderQueue()
+{
+	for (GpuTimer& timer : this->LayerTimers)
+		timer.Clear();
+	if (this->VAO == 0)
+		return;
+	glDeleteVertexArrays(1, &this->VAO);
+	glDeleteBuffers(1, &this->quadVBO);
+}
+
+void RenderQueue::Submit(RenderLayer layer, BlendMode blend, const Texture2D& texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec4 color)
+{
+	RenderCommand command;
+	command.Key = MakeKey(layer, blend, this->shader.ID, texture.ID);
+	command.Texture = texture.ID;
+	command.Position = position;
+	command.Size = size;
+	command.Rotation = rotate;
+	command.Color = color;
+	this->commands.push_back(command);
+}
+
+void RenderQueue::Sort(std::vector<RenderCommand>& commands)
+{
+	// stable so quads with identical state keep their submission order
+	std::stable_sort(this->commands.begin(), this->commands.end(),
+		[](const RenderCommand& a, const RenderCommand& b) { return a.Key < b.Key; });
+	// swap so the queue reuses the allocation of the previous list
+	commands.swap(this->commands);
+	this->commands.clear();
+}
+
+void RenderQueue::Execute(const std::vector<RenderCommand>& commands)
+{
+	this->Commands = commands.size();
+	this->Batches = 0;
+	if (commands.empty())
+		return;
+	if (this->VAO == 0)
+		this->initRenderData();
+
+	// the instance data of the whole frame, uploaded at once unless it's larger than the stream ring
+	this->instances.resize(commands.size());
+	for (unsigned int i = 0; i < commands.size(); ++i)
+	{
+		const RenderCommand& command = commands[i];
+		SpriteInstance& instance = this->instances[i];
+		instance.Rect[0] = command.Position.x;
+		instance.Rect[1] = command.Position.y;
+		instance.Rect[2] = command.Size.x;
+		instance.Rect[3] = command.Size.y;
+		instance.Color[0] = command.Color.r;
+		instance.Color[1] = command.Color.g;
+		instance.Color[2] = command.Color.b;
+		instance.Color[3] = command.Color.a;
+		instance.Rotation = command.Rotation;
+	}
+	const unsigned int chunkSize = this->stream->Size / sizeof(SpriteInstance);
+	unsigned int chunkStart = 0, chunkEnd = 0, base = 0;
+
+	this->shader.Use();
+	glActiveTexture(GL_TEXTURE0);
+	glBindVertexArray(this->VAO);
+	BlendMode currentBlend = BLEND_ALPHA;
+	unsigned int currentTexture = 0;
+	// every layer is timed, even an empty one, so each frame has a sample of all of them
+	unsigned int layer = LAYER_BACKGROUND;
+	this->LayerTimers[layer].Begin();
+	// draw every run of commands sharing the same key with one instanced call
+	for (unsigned int first = 0; first < commands.size();)
+	{
+		if (first == chunkEnd)
+		{
+			// the next chunk of instances; a run crossing a chunk boundary is drawn in two calls
+			chunkStart = first;
+			chunkEnd = std::min(static_cast<unsigned int>(commands.size()), first + chunkSize);
+			if (!this->stream->Upload(&this->instances[chunkStart], (chunkEnd - chunkStart) * sizeof(SpriteInstance), base, sizeof(SpriteInstance)))
+				break;
+		}
+		unsigned long long key = commands[first].Key;
+		unsigned int last = first + 1;
+		while (last < chunkEnd && commands[last].Key == key)
+			++last;
+
+		while (layer < KeyLayer(key))
+		{
+			this->LayerTimers[layer].End();
+			this->LayerTimers[++layer].Begin();
+		}
+		BlendMode blend = KeyBlend(key);
+		if (blend != currentBlend)
+		{
+			this->setBlendMode(blend);
+			currentBlend = blend;
+		}
+		if (commands[first].Texture != currentTexture)
+		{
+			currentTexture = commands[first].Texture;
+			glBindTexture(GL_TEXTURE_2D, currentTexture);
+			++RenderStats::Current.TextureBinds;
+		}
+		this->bindInstances(base + (first - chunkStart) * sizeof(SpriteInstance));
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, last - first);
+		RenderStats::Current.Draw(6 * (last - first));
+		++this->Batches;
+		first = last;
+	}
+	while (layer < LAYER_COUNT - 1)
+	{
+		this->LayerTimers[layer].End();
+		this->LayerTimers[++layer].Begin();
+	}
+	this->LayerTimers[layer].End();
+	glBindVertexArray(0);
+	// don't forget to reset to default blending mode
+	this->setBlendMode(BLEND_ALPHA);
+}
+
+void RenderQueue::ReplaceShader(unsigned int previous, const Shader& shader)
+{
+	if (this->shader.ID == previous)
+		this->shader = shader;
+}
+
+unsigned long long RenderQueue::MakeKey(RenderLayer layer, BlendMode blend, unsigned int shader, unsigned int texture)
+{
+	return (static_cast<unsigned long long>(layer & 0xFF) << KEY_LAYER_SHIFT) |
+		(static_cast<unsigned long long>(blend & 0xFF) << KEY_BLEND_SHIFT) |
+		(static_cast<unsigned long long>(shader & 0xFFFF) << KEY_SHADER_SHIFT) |
+		static_cast<unsigned long long>(texture);
+}
+
+RenderLayer RenderQueue::KeyLayer(unsigned long long key)
+{
+	return static_cast<RenderLayer>((key >> KEY_LAYER_SHIFT) & 0xFF);
+}
+
+BlendMode RenderQueue::KeyBlend(unsigned long long key)
+{
+	return static_cast<BlendMode>((key >> KEY_BLEND_SHIFT) & 0xFF);
+}
+
+void RenderQueue::initRenderData()
+{
+	float vertices[] = {
+		0.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 0.0f,
+
+		0.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 0.0f
+	};
+	glGenVertexArrays(1, &this->VAO);
+	glGenBuffers(1, &this->quadVBO);
+
+	glBindVertexArray(this->VAO);
+	// shared quad
+	glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	// per-instance rect, color and rotation
+	for (unsigned int attribute = 1; attribute <= 3; ++attribute)
+	{
+		glEnableVertexAttribArray(attribute);
+		glVertexAttribDivisor(attribute, 1);
+	}
+	this->bindInstances(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+void RenderQueue::bindInstances(size_t offset)
+{
+	// GL 3.3 has no base instance, so the attribute offsets move instead
+	glBindBuffer(GL_ARRAY_BUFFER, this->stream->ID);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, Rect)));
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, Color)));
+	glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, Rotation)));
+}
+
+void RenderQueue::setBlendMode(BlendMode blend)
+{
+	if (blend == BLEND_ADDITIVE)
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+	else
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+#include "shader.h"
+#include "stream_buffer.h"
+#include "gpu_timer.h"
+
+
+// Draw order of the scene, lower layers are drawn first
+enum RenderLayer {
+	LAYER_BACKGROUND,
+	LAYER_LEVEL,
+	LAYER_PLAYER,
+	LAYER_POWERUPS,
+	LAYER_PARTICLES,
+	LAYER_BALL,
+	LAYER_COUNT
+};
+
+// Blend modes a render command can be drawn with
+enum BlendMode {
+	BLEND_ALPHA,
+	BLEND_ADDITIVE
+};
+
+// A single textured and tinted quad submitted to the render queue
+struct RenderCommand {
+	unsigned long long Key; // layer | blend | shader | texture, see RenderQueue::MakeKey
+	unsigned int Texture;
+	glm::vec2 Position, Size;
+	float Rotation;
+	glm::vec4 Color;
+};
+
+// Per-instance vertex data of a batched quad
+struct SpriteInstance {
+	float Rect[4];  // position (xy) and size (zw)
+	float Color[4];
+	float Rotation; // degrees around the quad's center
+};
+
+// RenderQueue collects the quads of a frame tagged with a 64-bit sort key.
+// Commands are sorted by layer first, so the scene order is preserved, then
+// by blend mode, shader and texture so consecutive commands sharing all
+// state are merged into a single instanced draw when executed. Submitting
+// and sorting don't touch GL, only Execute has to run on the GL thread.
+class RenderQueue
+{
+public:
+	// number of commands and instanced draws of the last flush
+	unsigned int Commands, Batches;
+	// GPU time spent drawing each layer
+	GpuTimer LayerTimers[LAYER_COUNT];
+	// constructor (expects the instanced sprite shader); instance data is streamed through the given ring
+	RenderQueue(Shader shader, StreamBuffer* stream);
+	~RenderQueue();
+	// queues a quad; rotation is in degrees around the center and color tints the texture
+	void Submit(RenderLayer layer, BlendMode blend, const Texture2D& texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, glm::vec4 color = glm::vec4(1.0f));
+	// sorts the queued commands and moves them into commands, leaving the queue empty
+	void Sort(std::vector<RenderCommand>& commands);
+	// merges and draws a sorted list of commands
+	void Execute(const std::vector<RenderCommand>& commands);
+	// draws with a rebuilt shader if it replaces the queue's one
+	void ReplaceShader(unsigned int previous, const Shader& shader);
+	// builds a sort key; fields are ordered from most to least significant
+	static unsigned long long MakeKey(RenderLayer layer, BlendMode blend, unsigned int shader, unsigned int texture);
+	// layer stored in a sort key
+	static RenderLayer KeyLayer(unsigned long long key);
+	// blend mode stored in a sort key
+	static BlendMode KeyBlend(unsigned long long key);
+private:
+	Shader shader;
+	std::vector<RenderCommand> commands;
+	std::vector<SpriteInstance> instances;
+	// render state
+	StreamBuffer* stream;
+	unsigned int VAO, quadVBO;
+	void initRenderData();
+	// points the instance attributes at the instance data starting at the given byte offset of the stream
+	void bindInstances(size_t offset);
+	void setBlendMode(BlendMode blend);
+};
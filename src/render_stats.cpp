@@ -0,0 +1,14 @@
+#include "render_stats.h"
+
+RenderStats RenderStats::Current = RenderStats();
+
+void RenderStats::Reset()
+{
+	*this = RenderStats();
+}
+
+void RenderStats::Draw(unsigned int vertices)
+{
+	++this->DrawCalls;
+	this->Vertices += vertices;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+
+// RenderStats counts the GL work submitted in a frame. Counting is a plain
+// increment on the thread owning the context, cheap enough to stay enabled
+// in release builds, so the effect of batching changes can be measured in
+// the builds that ship.
+struct RenderStats {
+	unsigned int DrawCalls;
+	unsigned int Vertices;        // instanced draws count every instance
+	unsigned int TextureBinds;
+	unsigned int ProgramSwitches;
+	unsigned int UniformUploads;
+	unsigned int BufferUploads;
+	unsigned int BufferBytes;
+	// counters of the frame being drawn, reset by the renderer when a frame starts
+	static RenderStats Current;
+	// zeroes every counter
+	void Reset();
+	// counts a draw call of the given number of vertices
+	void Draw(unsigned int vertices);
+};
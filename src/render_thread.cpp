@@ -0,0 +1,58 @@
+#include <glad/glad.h>
+
+#include "render_thread.h"
+#include "game.h"
+
+RenderThread::RenderThread(GLFWwindow* window, Game& game)
+	: FrameTime(0.0f), window(window), game(game), running(false), pendingSize(0)
+{
+
+}
+
+void RenderThread::Start()
+{
+	// a context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+	this->running = true;
+	this->thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::Stop()
+{
+	if (!this->running)
+		return;
+	this->Snapshots.Close();
+	this->thread.join();
+	this->running = false;
+	glfwMakeContextCurrent(this->window);
+}
+
+void RenderThread::Resize(int width, int height)
+{
+	this->pendingSize = static_cast<unsigned long long>(width) << 32 | static_cast<unsigned int>(height);
+}
+
+bool RenderThread::Running() const
+{
+	return this->running;
+}
+
+void RenderThread::run()
+{
+	glfwMakeContextCurrent(this->window);
+	while (const FrameSnapshot* snapshot = this->Snapshots.Acquire())
+	{
+		unsigned long long size = this->pendingSize.exchange(0);
+		if (size != 0)
+		{
+			int width = static_cast<int>(size >> 32), height = static_cast<int>(size & 0xFFFFFFFF);
+			glViewport(0, 0, width, height);
+			this->game.Resize(width, height);
+		}
+		double start = glfwGetTime();
+		this->game.RenderSnapshot(*snapshot);
+		this->FrameTime = static_cast<float>((glfwGetTime() - start) * 1000.0);
+		glfwSwapBuffers(this->window);
+	}
+	glfwMakeContextCurrent(nullptr);
+}
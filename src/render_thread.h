@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include <GLFW/glfw3.h>
+
+#include "snapshot_buffer.h"
+
+class Game;
+
+
+// RenderThread owns the GL context while it runs: it draws the newest
+// snapshot the game published and swaps buffers, so simulating the next
+// frame overlaps with submitting the current one and the simulation never
+// waits on glfwSwapBuffers.
+class RenderThread
+{
+public:
+	// snapshots published by the game
+	SnapshotBuffer Snapshots;
+	// time (in milliseconds) the last frame took to submit, excluding the swap
+	std::atomic<float> FrameTime;
+	// constructor
+	RenderThread(GLFWwindow* window, Game& game);
+	// hands the GL context over from the calling thread and starts rendering
+	void Start();
+	// stops rendering and makes the GL context current on the calling thread again
+	void Stop();
+	// queues a framebuffer resize, applied by the render thread before its next frame
+	void Resize(int width, int height);
+	bool Running() const;
+private:
+	GLFWwindow* window;
+	Game& game;
+	std::thread thread;
+	std::atomic<bool> running;
+	// pending framebuffer size packed as width << 32 | height, 0 = none
+	std::atomic<unsigned long long> pendingSize;
+	void run();
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include "frame_snapshot.h"
+#include "shader.h"
+
+
+// Backend that consumes the frame snapshots built by the game. Game::Init
+// calls Init before any texture is loaded, so a backend can decide whether
+// textures are uploaded to GL (see ResourceManager::UploadTextures).
+class Renderer
+{
+public:
+	virtual ~Renderer() { }
+	// creates the backend's resources for a scene described in width x height units
+	virtual void Init(unsigned int width, unsigned int height) = 0;
+	// loads the glyphs the text commands are drawn with
+	virtual void LoadFont(std::string font, unsigned int fontSize) = 0;
+	// draws a snapshot; GL backends have to be called on the thread owning the context
+	virtual void Render(const FrameSnapshot& snapshot) = 0;
+	// the output (window framebuffer) changed size
+	virtual void Resize(unsigned int width, unsigned int height) = 0;
+	// bit of a post-processing pass in RenderSettings::Passes, -1 if the backend doesn't have it
+	virtual int PassIndex(const std::string& /*name*/) const { return -1; }
+	// GPU time of the recent frames in milliseconds, 0 if the backend doesn't measure it
+	virtual float GpuTime() const { return 0.0f; }
+	// a shader was rebuilt (hot reload): whatever draws with the previous program switches to the new one
+	virtual void ReplaceShader(unsigned int /*previous*/, const Shader& /*shader*/) { }
+};
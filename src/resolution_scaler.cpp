@@ -0,0 +1,34 @@
+#include "resolution_scaler.h"
+
+#include <algorithm>
+
+// frames to wait after a change before the scale may change again
+const unsigned int SCALE_COOLDOWN = 30;
+// fraction of the budget the frame time has to drop below before scaling up
+const float SCALE_UP_HEADROOM = 0.7f;
+
+ResolutionScaler::ResolutionScaler(float budget, float minScale, float maxScale, float step)
+	: Scale(maxScale), MinScale(minScale), MaxScale(maxScale), Step(step), Budget(budget), average(0.0f), framesSinceChange(0)
+{
+
+}
+
+bool ResolutionScaler::Update(float frameTime)
+{
+	// smooth out single slow frames
+	this->average = this->framesSinceChange == 0 ? frameTime : this->average * 0.9f + frameTime * 0.1f;
+	if (++this->framesSinceChange < SCALE_COOLDOWN)
+		return false;
+
+	float scale = this->Scale;
+	if (this->average > this->Budget)
+		scale = std::max(this->MinScale, this->Scale - this->Step);
+	else if (this->average < this->Budget * SCALE_UP_HEADROOM)
+		scale = std::min(this->MaxScale, this->Scale + this->Step);
+	if (scale == this->Scale)
+		return false;
+
+	this->Scale = scale;
+	this->framesSinceChange = 0;
+	return true;
+}
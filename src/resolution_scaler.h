@@ -0,0 +1,24 @@
+#pragma once
+
+
+// ResolutionScaler picks the render scale of the scene from measured frame
+// times. It steps the scale down while frames take longer than the budget
+// and back up once there is enough headroom, waiting a number of frames
+// after every step so the new resolution is measured before deciding again.
+class ResolutionScaler
+{
+public:
+	// current scene scale relative to the output resolution
+	float Scale;
+	// range and granularity of the scale
+	float MinScale, MaxScale, Step;
+	// frame time (in milliseconds) the scaler tries to stay under
+	float Budget;
+	// constructor
+	ResolutionScaler(float budget = 1000.0f / 60.0f, float minScale = 0.5f, float maxScale = 1.0f, float step = 0.125f);
+	// feeds the frame time of the last frame; returns true if Scale changed
+	bool Update(float frameTime);
+private:
+	float average;
+	unsigned int framesSinceChange;
+};
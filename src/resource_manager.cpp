@@ -1,95 +1,356 @@
 #include "resource_manager.h"
+#include "thread_pool.h"
+#include "texture_cache.h"
+#include "program_cache.h"
+#include "asset_pack.h"
 
 #include <iostream>
 #include <sstream>
-#include <fstream>
+#include <cstring>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-std::map<std::string, Texture2D> ResourceManager::Textures;
-std::map<std::string, Shader> ResourceManager::Shaders;
+std::vector<Shader> ResourceManager::Shaders;
+std::vector<std::string> ResourceManager::ShaderNames;
+std::vector<ShaderBuild> ResourceManager::ShaderBuilds;
+std::vector<Texture2D> ResourceManager::Textures;
+std::vector<std::string> ResourceManager::TextureNames;
+std::vector<std::string> ResourceManager::TextureFiles;
+std::map<std::string, unsigned int> ResourceManager::shaderIndices;
+std::map<std::string, unsigned int> ResourceManager::textureIndices;
+std::map<std::string, ShaderSource> ResourceManager::ShaderSources;
+std::vector<Image> ResourceManager::Images;
+bool ResourceManager::UploadTextures = true;
+ThreadPool* ResourceManager::loader = nullptr;
+std::vector<DecodedTexture> ResourceManager::decoded;
+unsigned int ResourceManager::pendingLoads = 0;
+std::mutex ResourceManager::loadMutex;
+std::condition_variable ResourceManager::loadDone;
 
 Shader ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name)
 {
-	Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-	return Shaders[name];
+	ShaderSource files = { vShaderFile, fShaderFile, gShaderFile != nullptr ? gShaderFile : "" };
+	ShaderSources[name] = files;
+	return GetShader(internShader(name, { files, {}, 0 }));
 }
 
-Shader ResourceManager::GetShader(std::string name)
+ShaderHandle ResourceManager::FindShader(const std::string& name)
 {
-	return Shaders[name];
+	ShaderHandle handle;
+	auto iter = shaderIndices.find(name);
+	if (iter != shaderIndices.end())
+		handle.Index = iter->second;
+	else
+		std::cout << "ERROR::SHADER: No shader loaded as " << name << std::endl;
+	return handle;
 }
 
-Texture2D ResourceManager::LoadTexture(const char* file, bool alpha, std::string name)
+Shader& ResourceManager::GetShader(ShaderHandle handle)
 {
-	Textures[name] = loadTextureFromFile(file, alpha);
-	return Textures[name];
+	static Shader missing;
+	if (handle.Index >= Shaders.size())
+	{
+		missing = Shader();
+		return missing;
+	}
+	return Shaders[handle.Index];
 }
 
-Texture2D ResourceManager::GetTexture(const std::string name)
+Shader& ResourceManager::GetShader(const std::string& name)
 {
-	return Textures[name];
+	return GetShader(FindShader(name));
 }
 
-void ResourceManager::Clear()
+Shader ResourceManager::GetShaderVariant(const std::string& name, const std::vector<std::string>& defines)
 {
-	for (auto iter : Shaders)
-		glDeleteProgram(iter.second.ID);
-	for (auto iter : Textures)
-		glDeleteTextures(1, &iter.second.ID);
+	if (defines.empty())
+		return GetShader(name);
+	// variants are stored next to their base shader as name[DEFINE_A,DEFINE_B]
+	std::string key = name + "[";
+	for (unsigned int i = 0; i < defines.size(); ++i)
+		key += (i > 0 ? "," : "") + defines[i];
+	key += "]";
+	auto iter = shaderIndices.find(key);
+	if (iter != shaderIndices.end())
+		return Shaders[iter->second];
+
+	auto source = ShaderSources.find(name);
+	if (source == ShaderSources.end())
+	{
+		std::cout << "ERROR::SHADER: No sources known for shader " << name << std::endl;
+		return Shader();
+	}
+	return GetShader(internShader(key, { source->second, defines, 0 }));
 }
 
-Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile)
+bool ResourceManager::ReadShader(const ShaderBuild& build, ShaderCode& code)
 {
-	std::string vertexCode;
-	std::string fragmentCode;
-	std::string geometryCode;
+	// read files, resolving includes and injecting the variant's defines
+	code.Vertex = preprocessShader(build.Files.Vertex, build.Defines);
+	code.Fragment = preprocessShader(build.Files.Fragment, build.Defines);
+	// if geometry shader path is present, also load a geometry shader
+	code.Geometry = build.Files.Geometry.empty() ? std::string() : preprocessShader(build.Files.Geometry, build.Defines);
+	code.Key = ProgramCache::Key(code.Vertex, code.Fragment, code.Geometry);
+	return !code.Vertex.empty() && !code.Fragment.empty() && (build.Files.Geometry.empty() || !code.Geometry.empty());
+}
 
-	try
+bool ResourceManager::ReplaceShader(const ShaderCode& code, unsigned int& previous)
+{
+	unsigned int index = code.Shader.Index;
+	if (index >= Shaders.size())
+		return false;
+	Shader shader;
+	if (!buildShader(code, shader))
 	{
-		// open file
-		std::ifstream vertexShaderFile(vShaderFile);
-		std::ifstream fragmentShaderFile(fShaderFile);
-		std::stringstream vShaderStream, fShaderStream;
-		// read file's a buffer contents into streams
-		vShaderStream << vertexShaderFile.rdbuf();
-		fShaderStream << fragmentShaderFile.rdbuf();
+		glDeleteProgram(shader.ID);
+		std::cout << "ERROR::SHADER: Keeping the previous version of " << ShaderNames[index] << std::endl;
+		return false;
+	}
+	previous = Shaders[index].ID;
+	glDeleteProgram(previous);
+	Shaders[index] = shader;
+	ShaderBuilds[index].Key = code.Key;
+	return true;
+}
 
-		// close file handlers
-		vertexShaderFile.close();
-		fragmentShaderFile.close();
-		// convert stream into string
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
-		// if geometry shader path is present, also load a geometry shader
-		if (gShaderFile != nullptr)
+ShaderHandle ResourceManager::internShader(const std::string& name, ShaderBuild build)
+{
+	ShaderCode code;
+	if (!ReadShader(build, code))
+		std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
+	build.Key = code.Key;
+	Shader shader;
+	buildShader(code, shader);
+
+	ShaderHandle handle;
+	auto iter = shaderIndices.find(name);
+	if (iter != shaderIndices.end())
+	{
+		// reloaded: the handles given out so far see the new program
+		handle.Index = iter->second;
+		glDeleteProgram(Shaders[handle.Index].ID);
+		Shaders[handle.Index] = shader;
+		ShaderBuilds[handle.Index] = build;
+		return handle;
+	}
+	handle.Index = Shaders.size();
+	shaderIndices[name] = handle.Index;
+	Shaders.push_back(shader);
+	ShaderNames.push_back(name);
+	ShaderBuilds.push_back(build);
+	return handle;
+}
+
+TextureHandle ResourceManager::LoadTexture(const char* file, bool alpha, std::string name)
+{
+	Texture2D texture = createPlaceholder(file, alpha);
+	TextureHandle handle;
+	auto iter = textureIndices.find(name);
+	if (iter != textureIndices.end())
+	{
+		handle.Index = iter->second;
+		Textures[handle.Index] = texture;
+		TextureFiles[handle.Index] = file;
+	}
+	else
+	{
+		handle.Index = Textures.size();
+		textureIndices[name] = handle.Index;
+		Textures.push_back(texture);
+		TextureNames.push_back(name);
+		TextureFiles.push_back(file);
+	}
+	// the software renderer samples RGBA images, GL textures are uploaded in their own format
+	queueLoad(texture, file, !UploadTextures || alpha ? 4 : 3);
+	return handle;
+}
+
+void ResourceManager::ReloadTexture(TextureHandle handle)
+{
+	if (handle.Index >= Textures.size())
+		return;
+	// decoded into the same texture, drawn with its current image until the upload
+	const Texture2D& texture = Textures[handle.Index];
+	queueLoad(texture, TextureFiles[handle.Index], !UploadTextures || texture.Image_Format == GL_RGBA ? 4 : 3);
+}
+
+void ResourceManager::queueLoad(const Texture2D& texture, const std::string& file, int channels)
+{
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		++pendingLoads;
+	}
+	if (!loader)
+		loader = new ThreadPool();
+	std::string path = file;
+	loader->Enqueue([texture, path, channels]() {
+		DecodedTexture result = { texture, TextureCache::Load(path, channels) };
 		{
-			std::cout << "gShaderFile: " << gShaderFile << std::endl;
-			std::ifstream geometryShaderFile(gShaderFile);
-			std::stringstream gShaderStream;
-			gShaderStream << geometryShaderFile.rdbuf();
-			geometryShaderFile.close();
-			geometryCode = gShaderStream.str();
+			std::lock_guard<std::mutex> lock(loadMutex);
+			decoded.push_back(result);
 		}
+		loadDone.notify_all();
+	});
+}
+
+unsigned int ResourceManager::ProcessTextureLoads(bool wait)
+{
+	std::vector<DecodedTexture> ready;
+	unsigned int pending;
+	{
+		std::unique_lock<std::mutex> lock(loadMutex);
+		if (wait)
+			loadDone.wait(lock, []() { return decoded.size() == pendingLoads; });
+		ready.swap(decoded);
+		pendingLoads -= ready.size();
+		pending = pendingLoads;
 	}
-	catch (std::exception e)
+	for (const DecodedTexture& texture : ready)
 	{
-		std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
-		
+		// an image that failed to load keeps its placeholder
+		if (texture.Baked)
+			uploadTexture(texture);
+		delete texture.Baked;
 	}
+	return pending;
+}
 
-	const char* vShaderCode = vertexCode.c_str();
-	const char* fShaderCode = fragmentCode.c_str();
-	const char* gShaderCode = geometryCode.c_str();
-	// 2. now create shader object from source code
-	Shader shader;
-	shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
+unsigned int ResourceManager::PendingLoads()
+{
+	std::lock_guard<std::mutex> lock(loadMutex);
+	return pendingLoads;
+}
 
-	return shader;
+TextureHandle ResourceManager::FindTexture(const std::string& name)
+{
+	TextureHandle handle;
+	auto iter = textureIndices.find(name);
+	if (iter != textureIndices.end())
+		handle.Index = iter->second;
+	else
+		std::cout << "ERROR::TEXTURE: No texture loaded as " << name << std::endl;
+	return handle;
+}
+
+const Texture2D& ResourceManager::GetTexture(TextureHandle handle)
+{
+	static const Texture2D missing;
+	if (handle.Index >= Textures.size())
+		return missing;
+	return Textures[handle.Index];
 }
 
-Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
+const Texture2D& ResourceManager::GetTexture(const std::string& name)
+{
+	return GetTexture(FindTexture(name));
+}
+
+const Image* ResourceManager::GetImage(unsigned int textureID)
+{
+	if (textureID == 0 || textureID > Images.size())
+		return nullptr;
+	return &Images[textureID - 1];
+}
+
+void ResourceManager::Clear()
+{
+	// let the loads in progress finish before their textures go away
+	delete loader;
+	loader = nullptr;
+	for (const DecodedTexture& texture : decoded)
+		delete texture.Baked;
+	decoded.clear();
+	pendingLoads = 0;
+	for (const Shader& shader : Shaders)
+		glDeleteProgram(shader.ID);
+	if (UploadTextures)
+	{
+		for (const Texture2D& texture : Textures)
+			glDeleteTextures(1, &texture.ID);
+	}
+	// every handle given out so far is invalid from here on
+	Shaders.clear();
+	ShaderNames.clear();
+	ShaderBuilds.clear();
+	shaderIndices.clear();
+	Textures.clear();
+	TextureNames.clear();
+	TextureFiles.clear();
+	textureIndices.clear();
+	Images.clear();
+}
+
+bool ResourceManager::buildShader(const ShaderCode& code, Shader& shader)
+{
+	// restore the linked program from the cache when these sources were linked before on this driver
+	shader.ID = ProgramCache::Load(code.Key);
+	if (shader.ID != 0)
+		return true;
+	// otherwise create shader object from source code
+	if (!shader.Compile(code.Vertex.c_str(), code.Fragment.c_str(), code.Geometry.empty() ? nullptr : code.Geometry.c_str()))
+		return false;
+	ProgramCache::Store(code.Key, shader.ID);
+	return true;
+}
+
+std::string ResourceManager::preprocessShader(const std::string& file, const std::vector<std::string>& defines, int depth)
+{
+	// guard against include cycles
+	if (depth > 16)
+	{
+		std::cout << "ERROR::SHADER: Include depth exceeded in " << file << std::endl;
+		return std::string();
+	}
+	// read in place from the asset pack or the mapped file
+	Asset shaderFile;
+	if (!shaderFile.Open(file))
+	{
+		std::cout << "ERROR::SHADER: Failed to open " << file << std::endl;
+		return std::string();
+	}
+	// includes are resolved relative to the including file
+	std::string directory;
+	size_t slash = file.find_last_of("/\\");
+	if (slash != std::string::npos)
+		directory = file.substr(0, slash + 1);
+
+	std::stringstream output;
+	const char* text = reinterpret_cast<const char*>(shaderFile.Data);
+	const char* end = text + shaderFile.Size;
+	while (text < end)
+	{
+		const char* newline = static_cast<const char*>(std::memchr(text, '\n', end - text));
+		std::string line(text, newline ? newline : end);
+		text = newline ? newline + 1 : end;
+		size_t start = line.find_first_not_of(" \t");
+		if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+		{
+			size_t open = line.find('"', start);
+			size_t close = line.find('"', open + 1);
+			if (open == std::string::npos || close == std::string::npos)
+			{
+				std::cout << "ERROR::SHADER: Malformed include in " << file << ": " << line << std::endl;
+				continue;
+			}
+			// defines are only injected once at the top of the root file
+			output << preprocessShader(directory + line.substr(open + 1, close - open - 1), {}, depth + 1);
+		}
+		else
+		{
+			output << line << '\n';
+			// #version has to stay the first statement, so the defines go right after it
+			if (start != std::string::npos && line.compare(start, 8, "#version") == 0)
+			{
+				for (const std::string& define : defines)
+					output << "#define " << define << '\n';
+			}
+		}
+	}
+	return output.str();
+}
+
+Texture2D ResourceManager::createPlaceholder(const char* file, bool alpha)
 {
 	Texture2D texture;
 	if (alpha)
@@ -97,13 +358,58 @@ Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
 		texture.Internal_Format = GL_RGBA;
 		texture.Image_Format = GL_RGBA;
 	}
-
-	// load image
-	int width, height, nrChannels;
-	unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
-	// now generate texture
-	texture.Generate(width, height, data);
-	// and finally free image data
-	stbi_image_free(data);
+	// black, or fully transparent for textures with alpha
+	unsigned char pixel[4] = { 0, 0, 0, static_cast<unsigned char>(alpha ? 0 : 255) };
+	if (UploadTextures)
+	{
+		texture.Generate(1, 1, pixel);
+	}
+	else
+	{
+		// keep the image in memory and hand out its (1-based) index as texture ID
+		Image image = { 1, 1, std::vector<unsigned int>(1, static_cast<unsigned int>(pixel[3]) << 24) };
+		Images.push_back(image);
+		texture.ID = Images.size();
+	}
+	// the header is enough to report the final size right away (read in place, from the pack if there is one)
+	int width = 1, height = 1, nrChannels;
+	Asset source;
+	if (source.Open(file))
+		stbi_info_from_memory(source.Data, static_cast<int>(source.Size), &width, &height, &nrChannels);
+	texture.Width = width;
+	texture.Height = height;
 	return texture;
-}
\ No newline at end of file
+}
+
+void ResourceManager::uploadTexture(const DecodedTexture& decoded)
+{
+	const BakedTexture& baked = *decoded.Baked;
+	unsigned int width, height;
+	if (UploadTextures)
+	{
+		// same GL texture as the placeholder, so every copy of the handle sees the image
+		Texture2D texture = decoded.Texture;
+		if (baked.Levels > 1)
+			texture.Filter_Min = GL_LINEAR_MIPMAP_LINEAR;
+		// baked rows are tightly packed
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		texture.Generate(baked.Width, baked.Height, baked.Level(0, width, height));
+		for (unsigned int level = 1; level < baked.Levels; ++level)
+		{
+			const unsigned char* data = baked.Level(level, width, height);
+			texture.GenerateLevel(level, width, height, data);
+		}
+		return;
+	}
+	// the software renderer samples the full size image only
+	const unsigned char* data = baked.Level(0, width, height);
+	Image& image = Images[decoded.Texture.ID - 1];
+	image.Width = width;
+	image.Height = height;
+	image.Pixels.resize(width * height);
+	for (unsigned int i = 0; i < width * height; ++i)
+	{
+		const unsigned char* rgba = data + i * 4;
+		image.Pixels[i] = static_cast<unsigned int>(rgba[3]) << 24 | rgba[0] << 16 | rgba[1] << 8 | rgba[2];
+	}
+}
@@ -1,26 +1,138 @@
 #pragma once
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
 #include "texture.h"
 #include "shader.h"
 
+class ThreadPool;
+
+// Source files a shader was loaded from, so specialized variants can be compiled from them on demand
+struct ShaderSource {
+	std::string Vertex;
+	std::string Fragment;
+	std::string Geometry; // empty if the shader has no geometry stage
+};
+
+// How an interned shader was built, so it can be built again when its files change
+struct ShaderBuild {
+	ShaderSource Files;
+	std::vector<std::string> Defines;
+	unsigned long long Key; // ProgramCache key of the sources it was built from
+};
+
+// CPU copy of a texture, as sampled by the software renderer
+struct Image {
+	unsigned int Width, Height;
+	std::vector<unsigned int> Pixels; // 0xAARRGGBB, rows top to bottom
+};
+
+class BakedTexture;
+
+// Interned resource names: the index of a resource in ResourceManager's
+// arrays. Names are looked up once, when loading or initializing, and the
+// handle resolves in O(1) afterwards; a default handle refers to nothing.
+const unsigned int INVALID_RESOURCE = 0xFFFFFFFF;
+struct TextureHandle {
+	unsigned int Index = INVALID_RESOURCE;
+	bool Valid() const { return Index != INVALID_RESOURCE; }
+};
+struct ShaderHandle {
+	unsigned int Index = INVALID_RESOURCE;
+	bool Valid() const { return Index != INVALID_RESOURCE; }
+};
+
+// Preprocessed sources of a shader, ready to be compiled
+struct ShaderCode {
+	ShaderHandle Shader;
+	std::string Vertex, Fragment, Geometry;
+	unsigned long long Key;
+};
+
+// An image loaded by a loader thread, waiting to be uploaded into its texture
+struct DecodedTexture {
+	Texture2D Texture;   // handle handed out by LoadTexture
+	BakedTexture* Baked; // nullptr if the file couldn't be loaded
+};
+
+// Textures are loaded asynchronously: LoadTexture returns a handle to a 1x1
+// placeholder at once and loads the file on a thread pool, through the
+// baked texture cache (no decoding unless the source changed); the images
+// are uploaded into the same handles by ProcessTextureLoads, called on the
+// GL thread. Copies of a handle therefore stay valid throughout.
 class ResourceManager
 {
 public:
-	static std::map<std::string, Shader> Shaders;
-	static std::map<std::string, Texture2D> Textures;
+	// false keeps textures in memory as images instead of uploading them (no GL context needed)
+	static bool UploadTextures;
+	// loaded resources and their names, indexed by handle
+	static std::vector<Shader> Shaders;
+	static std::vector<std::string> ShaderNames;
+	static std::vector<ShaderBuild> ShaderBuilds;
+	static std::vector<Texture2D> Textures;
+	static std::vector<std::string> TextureNames;
+	static std::vector<std::string> TextureFiles;
+	static std::map<std::string, ShaderSource> ShaderSources;
+	static std::vector<Image> Images; // indexed by texture ID - 1
 	static Shader LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name);
-	static Shader GetShader(std::string name);
-	static Texture2D LoadTexture(const char* file, bool alpha, std::string name);
-	static Texture2D GetTexture(const std::string name);
+	// handle of a loaded shader; an error and an invalid handle if there is none by that name
+	static ShaderHandle FindShader(const std::string& name);
+	// shader of a handle; an invalid handle gets an empty shader (ID 0)
+	static Shader& GetShader(ShaderHandle handle);
+	static Shader& GetShader(const std::string& name);
+	// returns the variant of a loaded shader compiled with the given #defines, compiling it on first use
+	static Shader GetShaderVariant(const std::string& name, const std::vector<std::string>& defines);
+	// reads and preprocesses the files of a shader build (any thread); false if a file can't be read
+	static bool ReadShader(const ShaderBuild& build, ShaderCode& code);
+	// compiles new sources for a loaded shader (GL thread). If they fail to compile or link the
+	// previous program stays; otherwise it is deleted and its ID returned in previous
+	static bool ReplaceShader(const ShaderCode& code, unsigned int& previous);
+	// starts loading a texture and returns the handle of its placeholder
+	static TextureHandle LoadTexture(const char* file, bool alpha, std::string name);
+	// loads a texture's file again; its current image stays until the new one is uploaded, or if it fails to load
+	static void ReloadTexture(TextureHandle handle);
+	// uploads the textures decoded so far (GL thread); wait blocks until every load finished.
+	// Returns the number of loads still in progress
+	static unsigned int ProcessTextureLoads(bool wait = false);
+	// number of loads not uploaded yet, decoded or not
+	static unsigned int PendingLoads();
+	// handle of a loaded texture; an error and an invalid handle if there is none by that name
+	static TextureHandle FindTexture(const std::string& name);
+	// texture of a handle; an invalid handle gets an empty texture (ID 0)
+	static const Texture2D& GetTexture(TextureHandle handle);
+	static const Texture2D& GetTexture(const std::string& name);
+	// image of a texture loaded while UploadTextures was off, nullptr if there is none
+	static const Image* GetImage(unsigned int textureID);
 	static void Clear();
 
 private:
 	ResourceManager(){}
-	static Shader loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr);
-	static Texture2D loadTextureFromFile(const char* file, bool alpha);
+	// name to handle index
+	static std::map<std::string, unsigned int> shaderIndices;
+	static std::map<std::string, unsigned int> textureIndices;
+	// builds a shader and stores it under a name, replacing one loaded before
+	static ShaderHandle internShader(const std::string& name, ShaderBuild build);
+	// restores a program from the program cache or compiles it; false if it fails to compile or link
+	static bool buildShader(const ShaderCode& code, Shader& shader);
+	// reads a shader file, expanding #include directives and inserting the given #defines after #version
+	static std::string preprocessShader(const std::string& file, const std::vector<std::string>& defines, int depth = 0);
+	// creates the placeholder a texture is shown with until its image is uploaded
+	static Texture2D createPlaceholder(const char* file, bool alpha);
+	// queues the decoding of a texture's file
+	static void queueLoad(const Texture2D& texture, const std::string& file, int channels);
+	// replaces a placeholder with the decoded image
+	static void uploadTexture(const DecodedTexture& decoded);
+	// decoding threads, created with the first load
+	static ThreadPool* loader;
+	// decoded images not uploaded yet and the number of loads not uploaded yet
+	static std::vector<DecodedTexture> decoded;
+	static unsigned int pendingLoads;
+	static std::mutex loadMutex;
+	static std::condition_variable loadDone;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 
 #include "shader.h"
+#include "render_stats.h"
+#include "program_cache.h"
 
 
 #include <iostream>
@@ -7,10 +9,11 @@
 Shader& Shader::Use()
 {
 	glUseProgram(this->ID);
+	++RenderStats::Current.ProgramSwitches;
 	return *this;
 }
 
-void Shader::Compile(const char* vertesSource, const char* fragmentSource, const char* geometrySource)
+bool Shader::Compile(const char* vertesSource, const char* fragmentSource, const char* geometrySource)
 {
 	unsigned int sVertex, sFragment, gShader;
 	// vertex shader
@@ -42,13 +45,16 @@ void Shader::Compile(const char* vertesSource, const char* fragmentSource, const
 	{
 		glAttachShader(this->ID, gShader);
 	}
+	ProgramCache::HintRetrievable(this->ID);
 	glLinkProgram(this->ID);
-	checkCompileError(this->ID, "PROGRAM");
+	// a stage that failed to compile fails the link as well
+	bool linked = checkCompileError(this->ID, "PROGRAM");
 	// delete the shaders as they're linked into our program now and no longer necessary
 	glDeleteShader(sVertex);
 	glDeleteShader(sFragment);
 	if (geometrySource != nullptr)
 		glDeleteShader(gShader);
+	return linked;
 }
 
 void Shader::SetFloat(const char* name, float value, bool useShader)
@@ -56,6 +62,7 @@ void Shader::SetFloat(const char* name, float value, bool useShader)
 	if (useShader)
 		this->Use();
 	glUniform1f(glGetUniformLocation(this->ID, name), value);
+	++RenderStats::Current.UniformUploads;
 }
 
 void Shader::SetInteger(const char* name, int value, bool useShader)
@@ -63,6 +70,7 @@ void Shader::SetInteger(const char* name, int value, bool useShader)
 	if (useShader)
 		this->Use();
 	glUniform1i(glGetUniformLocation(this->ID, name), value);
+	++RenderStats::Current.UniformUploads;
 }
 
 void Shader::SetVector2f(const char* name, float x, float y, bool useShader)
@@ -70,6 +78,7 @@ void Shader::SetVector2f(const char* name, float x, float y, bool useShader)
 	if (useShader)
 		this->Use();
 	glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+	++RenderStats::Current.UniformUploads;
 }
 
 void Shader::SetVector2f(const char* name, const glm::vec2& value, bool useShader)
@@ -77,6 +86,7 @@ void Shader::SetVector2f(const char* name, const glm::vec2& value, bool useShade
 	if (useShader)
 		this->Use();
 	glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+	++RenderStats::Current.UniformUploads;
 }
 
 void Shader::SetVector3f(const char* name, float x, float y, float z, bool useShader)
@@ -84,6 +94,7 @@ void Shader::SetVector3f(const char* name, float x, float y, float z, bool useSh
 	if (useShader)
 		this->Use();
 	glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+	++RenderStats::Current.UniformUploads;
 }
 
 
@@ -92,6 +103,7 @@ void Shader::SetVector3f(const char* name, const glm::vec3& value, bool useShade
 	if (useShader)
 		this->Use();
 	glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+	++RenderStats::Current.UniformUploads;
 }
 
 void Shader::SetVector4f(const char* name, float x, float y, float z, float w, bool useShader)
@@ -99,6 +111,7 @@ void Shader::SetVector4f(const char* name, float x, float y, float z, float w, b
 	if (useShader)
 		this->Use();
 	glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+	++RenderStats::Current.UniformUploads;
 }
 
 void Shader::SetVector4f(const char* name, const glm::vec4& value, bool useShader)
@@ -106,6 +119,7 @@ void Shader::SetVector4f(const char* name, const glm::vec4& value, bool useShade
 	if (useShader)
 		this->Use();
 	glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+	++RenderStats::Current.UniformUploads;
 
 }
 
@@ -114,9 +128,10 @@ void Shader::SetMatrix4(const char* name, const glm::mat4& matrix, bool useShade
 	if (useShader)
 		this->Use();
 	glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
+	++RenderStats::Current.UniformUploads;
 }
 
-void Shader::checkCompileError(unsigned int object, std::string type)
+bool Shader::checkCompileError(unsigned int object, std::string type)
 {
 	int success;
 	char infoLog[1024];
@@ -142,4 +157,5 @@ void Shader::checkCompileError(unsigned int object, std::string type)
 				<< std::endl;
 		}
 	}
+	return success != 0;
 }
\ No newline at end of file
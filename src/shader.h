@@ -14,7 +14,8 @@ public:
 	unsigned int ID;
 	Shader(): ID(0) {}
 	Shader& Use();
-	void Compile(const char* vertesSource, const char* fragmentSource, const char* geometrySource = nullptr);
+	// compiles and links the program; false if any stage fails (the errors are printed)
+	bool Compile(const char* vertesSource, const char* fragmentSource, const char* geometrySource = nullptr);
 	void SetFloat(const char* name, float value, bool useShader = false);
 	void SetInteger(const char* name, int value, bool useShader = false);
 	void SetVector2f(const char* name, float x, float y, bool useShader = false);
@@ -25,5 +26,5 @@ public:
 	void SetVector4f(const char* name, const glm::vec4& value, bool useShader = false);
 	void SetMatrix4(const char* name, const glm::mat4& matrix, bool useShader = false);
 private:
-	void checkCompileError(unsigned int object, std::string type);
+	bool checkCompileError(unsigned int object, std::string type);
 };
\ No newline at end of file
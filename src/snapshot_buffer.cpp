@@ -0,0 +1,44 @@
+#include "snapshot_buffer.h"
+
+#include <utility>
+
+SnapshotBuffer::SnapshotBuffer()
+	: writeIndex(0), readyIndex(1), readIndex(2), fresh(false), closed(false)
+{
+
+}
+
+FrameSnapshot& SnapshotBuffer::WriteSlot()
+{
+	return this->slots[this->writeIndex];
+}
+
+void SnapshotBuffer::Publish()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		std::swap(this->writeIndex, this->readyIndex);
+		this->fresh = true;
+	}
+	this->available.notify_one();
+}
+
+const FrameSnapshot* SnapshotBuffer::Acquire()
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	this->available.wait(lock, [this] { return this->fresh || this->closed; });
+	if (this->closed)
+		return nullptr;
+	std::swap(this->readIndex, this->readyIndex);
+	this->fresh = false;
+	return &this->slots[this->readIndex];
+}
+
+void SnapshotBuffer::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->closed = true;
+	}
+	this->available.notify_all();
+}
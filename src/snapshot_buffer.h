@@ -0,0 +1,33 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+#include "frame_snapshot.h"
+
+
+// SnapshotBuffer hands frame snapshots from the simulation to the render
+// thread through three slots: the producer fills its own slot and swaps it
+// with the shared 'ready' slot on Publish, the consumer swaps the ready slot
+// with its own on Acquire. The producer never waits; if it publishes faster
+// than frames are drawn, the renderer simply skips to the newest snapshot.
+class SnapshotBuffer
+{
+public:
+	// constructor
+	SnapshotBuffer();
+	// slot the producer fills for the next Publish
+	FrameSnapshot& WriteSlot();
+	// makes the filled write slot the newest snapshot
+	void Publish();
+	// waits for a snapshot newer than the last acquired one; returns nullptr once closed
+	const FrameSnapshot* Acquire();
+	// wakes up and stops the consumer
+	void Close();
+private:
+	FrameSnapshot slots[3];
+	unsigned int writeIndex, readyIndex, readIndex;
+	bool fresh, closed;
+	std::mutex mutex;
+	std::condition_variable available;
+};
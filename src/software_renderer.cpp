@@ -0,0 +1,391 @@
+#include "software_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <stb_image_write.h>
+
+#include "asset_pack.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_SSE2
+#endif
+
+// rows per band handed to a worker, small enough to balance the load between threads
+const int BAND_HEIGHT = 16;
+// pixels gathered before they are blended as one span
+const int SPAN_CHUNK = 256;
+// color the scene is cleared to (opaque black)
+const unsigned int CLEAR_COLOR = 0xFF000000;
+
+// tints are fixed point with 1.0 = 128, so colors up to 2.0 (the particles go up to 1.5) fit 16-bit lanes
+int tintComponent(float value)
+{
+	return std::max(0, std::min(256, static_cast<int>(value * 128.0f + 0.5f)));
+}
+
+#ifdef SOFTWARE_SSE2
+// blends two pixels unpacked to 16-bit lanes (b, g, r, a, b, g, r, a)
+inline __m128i blendPixels(__m128i src, __m128i dst, __m128i tint, BlendMode blend)
+{
+	// tint and clamp the source like GL clamps fragment colors for a fixed-point target
+	src = _mm_min_epi16(_mm_srli_epi16(_mm_mullo_epi16(src, tint), 7), _mm_set1_epi16(255));
+	__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	alpha = _mm_add_epi16(alpha, _mm_srli_epi16(alpha, 7)); // 0..255 -> 0..256
+	if (blend == BLEND_ADDITIVE) // src * a + dst, saturated when packing
+		return _mm_add_epi16(dst, _mm_srli_epi16(_mm_mullo_epi16(src, alpha), 8));
+	// src * a + dst * (1 - a)
+	__m128i inverse = _mm_sub_epi16(_mm_set1_epi16(256), alpha);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, inverse)), 8);
+}
+#endif
+
+// blends a span of gathered texels (0xAARRGGBB) onto the target, tint holds b, g, r, a
+void blendSpan(unsigned int* dst, const unsigned int* src, int count, const int tint[4], BlendMode blend)
+{
+	int x = 0;
+#ifdef SOFTWARE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i tints = _mm_set_epi16(tint[3], tint[2], tint[1], tint[0], tint[3], tint[2], tint[1], tint[0]);
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+		__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + x));
+		__m128i low = blendPixels(_mm_unpacklo_epi8(texels, zero), _mm_unpacklo_epi8(pixels, zero), tints, blend);
+		__m128i high = blendPixels(_mm_unpackhi_epi8(texels, zero), _mm_unpackhi_epi8(pixels, zero), tints, blend);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(low, high));
+	}
+#endif
+	// same math one pixel at a time for the remainder (or everything without SSE2)
+	for (; x < count; ++x)
+	{
+		unsigned int texel = src[x], pixel = dst[x];
+		int channels[4];
+		for (int c = 0; c < 4; ++c)
+			channels[c] = std::min(255, static_cast<int>((texel >> (c * 8)) & 0xFF) * tint[c] >> 7);
+		int alpha = channels[3] + (channels[3] >> 7);
+		unsigned int result = 0;
+		for (int c = 0; c < 4; ++c)
+		{
+			int d = (pixel >> (c * 8)) & 0xFF;
+			int value = blend == BLEND_ADDITIVE ? d + (channels[c] * alpha >> 8) : (channels[c] * alpha + d * (256 - alpha)) >> 8;
+			result |= static_cast<unsigned int>(std::min(255, value)) << (c * 8);
+		}
+		dst[x] = result;
+	}
+}
+
+// wraps a coordinate like GL_REPEAT
+inline int wrap(int value, int size)
+{
+	value %= size;
+	return value < 0 ? value + size : value;
+}
+
+// 3x3 convolution (kernel weights divided by 2^shift, see kernel.glsl) of the pixels at columns
+// left, center and right of three rows
+unsigned int convolve(const unsigned int* rows[3], int left, int center, int right, const int kernel[9], int shift)
+{
+	const int columns[3] = { left, center, right };
+#ifdef SOFTWARE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sum = zero;
+	for (int i = 0; i < 9; ++i)
+	{
+		__m128i tap = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(rows[i / 3][columns[i % 3]])), zero);
+		sum = _mm_add_epi16(sum, _mm_mullo_epi16(tap, _mm_set1_epi16(static_cast<short>(kernel[i]))));
+	}
+	// negative sums (edge kernel) saturate to 0 when packing
+	sum = _mm_sra_epi16(sum, _mm_cvtsi32_si128(shift));
+	return static_cast<unsigned int>(_mm_cvtsi128_si32(_mm_packus_epi16(sum, zero))) | CLEAR_COLOR;
+#else
+	int sum[3] = { 0, 0, 0 };
+	for (int i = 0; i < 9; ++i)
+	{
+		unsigned int tap = rows[i / 3][columns[i % 3]];
+		for (int c = 0; c < 3; ++c)
+			sum[c] += static_cast<int>((tap >> (c * 8)) & 0xFF) * kernel[i];
+	}
+	unsigned int result = CLEAR_COLOR;
+	for (int c = 0; c < 3; ++c)
+		result |= static_cast<unsigned int>(std::max(0, std::min(255, sum[c] >> shift))) << (c * 8);
+	return result;
+#endif
+}
+
+SoftwareRenderer::SoftwareRenderer(ThreadPool& pool)
+	: Width(0), Height(0), pool(pool), sceneWidth(1), sceneHeight(1)
+{
+
+}
+
+void SoftwareRenderer::Init(unsigned int width, unsigned int height)
+{
+	ResourceManager::UploadTextures = false;
+	this->sceneWidth = width;
+	this->sceneHeight = height;
+	this->Resize(width, height);
+}
+
+void SoftwareRenderer::LoadFont(std::string font, unsigned int fontSize)
+{
+	this->glyphs.clear();
+	FT_Library ft;
+	if (FT_Init_FreeType(&ft))
+	{
+		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+		return;
+	}
+	// read in place, the data only has to outlive the face
+	Asset fontFile;
+	FT_Face face;
+	if (!fontFile.Open(font) || FT_New_Memory_Face(ft, fontFile.Data, static_cast<FT_Long>(fontFile.Size), 0, &face))
+	{
+		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+		FT_Done_FreeType(ft);
+		return;
+	}
+	FT_Set_Pixel_Sizes(face, 0, fontSize);
+	for (unsigned char c = 0; c < 128; c++)
+	{
+		if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+		{
+			std::cout << "ERROR::FREETYPE: Failed to load Glyph" << std::endl;
+			continue;
+		}
+		const FT_Bitmap& bitmap = face->glyph->bitmap;
+		SoftwareGlyph glyph;
+		glyph.Bitmap.Width = bitmap.width;
+		glyph.Bitmap.Height = bitmap.rows;
+		glyph.Bitmap.Pixels.resize(bitmap.width * bitmap.rows);
+		// white with the coverage as alpha, so the text color is applied as tint
+		for (unsigned int y = 0; y < bitmap.rows; ++y)
+			for (unsigned int x = 0; x < bitmap.width; ++x)
+				glyph.Bitmap.Pixels[y * bitmap.width + x] = static_cast<unsigned int>(bitmap.buffer[y * bitmap.pitch + x]) << 24 | 0xFFFFFF;
+		glyph.Bearing = glm::vec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+		glyph.Advance = face->glyph->advance.x;
+		this->glyphs[c] = glyph;
+	}
+	FT_Done_Face(face);
+	FT_Done_FreeType(ft);
+}
+
+void SoftwareRenderer::Resize(unsigned int width, unsigned int height)
+{
+	this->Width = width;
+	this->Height = height;
+	this->Pixels.assign(width * height, CLEAR_COLOR);
+	this->scene.assign(width * height, CLEAR_COLOR);
+}
+
+void SoftwareRenderer::Render(const FrameSnapshot& snapshot)
+{
+	// resolve textures and pixel bounds once, the bands only read the quads
+	this->quads.clear();
+	for (const RenderCommand& command : snapshot.Commands)
+		this->addQuad(this->quads, ResourceManager::GetImage(command.Texture), command.Position, command.Size,
+			command.Rotation, command.Color, RenderQueue::KeyBlend(command.Key));
+	// text is laid out like TextRenderer::RenderText
+	this->texts.clear();
+	float capHeight = this->glyphs.count('H') ? this->glyphs['H'].Bearing.y : 0.0f;
+	for (const TextCommand& text : snapshot.Texts)
+	{
+		float x = text.X;
+		for (char c : text.Text)
+		{
+			auto iter = this->glyphs.find(c);
+			if (iter == this->glyphs.end())
+				continue;
+			const SoftwareGlyph& glyph = iter->second;
+			glm::vec2 position(x + glyph.Bearing.x * text.Scale, text.Y + (capHeight - glyph.Bearing.y) * text.Scale);
+			glm::vec2 size(glyph.Bitmap.Width * text.Scale, glyph.Bitmap.Height * text.Scale);
+			this->addQuad(this->texts, &glyph.Bitmap, position, size, 0.0f, glm::vec4(text.Color, 1.0f), BLEND_ALPHA);
+			x += (glyph.Advance >> 6) * text.Scale;
+		}
+	}
+
+	const EffectFlags& effects = snapshot.Effects;
+	bool postProcess = effects.Chaos || effects.Confuse || effects.Shake;
+	unsigned int* target = postProcess ? this->scene.data() : this->Pixels.data();
+	unsigned int bands = (this->Height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+	this->pool.ParallelFor(bands, [&](unsigned int band) {
+		int top = band * BAND_HEIGHT;
+		int bottom = std::min<int>(top + BAND_HEIGHT, this->Height);
+		std::fill(target + top * this->Width, target + bottom * this->Width, CLEAR_COLOR);
+		this->rasterize(this->quads, target, top, bottom);
+		if (!postProcess)
+			this->rasterize(this->texts, this->Pixels.data(), top, bottom);
+	});
+	if (!postProcess)
+		return;
+	// the effects sample other rows (chaos anywhere in the image), so they wait for the whole scene
+	this->pool.ParallelFor(bands, [&](unsigned int band) {
+		int top = band * BAND_HEIGHT;
+		int bottom = std::min<int>(top + BAND_HEIGHT, this->Height);
+		this->applyEffects(effects, snapshot.Time, top, bottom);
+		this->rasterize(this->texts, this->Pixels.data(), top, bottom);
+	});
+}
+
+bool SoftwareRenderer::SaveFrame(const std::string& file) const
+{
+	// the same layout as the headless dumps, so the two can be compared byte for byte
+	std::vector<unsigned char> rgb(this->Width * this->Height * 3);
+	for (unsigned int i = 0; i < this->Width * this->Height; ++i)
+	{
+		unsigned int pixel = this->Pixels[i];
+		rgb[i * 3 + 0] = (pixel >> 16) & 0xFF;
+		rgb[i * 3 + 1] = (pixel >> 8) & 0xFF;
+		rgb[i * 3 + 2] = pixel & 0xFF;
+	}
+	if (!stbi_write_png(file.c_str(), this->Width, this->Height, 3, rgb.data(), this->Width * 3))
+	{
+		std::cout << "ERROR::SOFTWARE: Failed to write frame: " << file << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void SoftwareRenderer::addQuad(std::vector<Quad>& list, const Image* texture, glm::vec2 position, glm::vec2 size, float rotation, glm::vec4 color, BlendMode blend)
+{
+	if (!texture || texture->Width == 0 || color.a <= 0.0f || size.x <= 0.0f || size.y <= 0.0f)
+		return;
+	// scene coordinates to framebuffer pixels, like the GL viewport transform
+	glm::vec2 scale(static_cast<float>(this->Width) / this->sceneWidth, static_cast<float>(this->Height) / this->sceneHeight);
+	// the covered pixels are worked out below
+	Quad quad = { texture, position * scale, size * scale, rotation, color, blend, 0, 0, 0, 0 };
+	// a pixel is covered if its center is inside the (rotated) quad
+	glm::vec2 center = quad.Position + quad.Size * 0.5f;
+	glm::vec2 extent = quad.Size * 0.5f;
+	if (rotation != 0.0f)
+	{
+		float c = std::fabs(std::cos(glm::radians(rotation))), s = std::fabs(std::sin(glm::radians(rotation)));
+		extent = glm::vec2(c * extent.x + s * extent.y, s * extent.x + c * extent.y);
+	}
+	quad.MinX = std::max(0, static_cast<int>(std::ceil(center.x - extent.x - 0.5f)));
+	quad.MinY = std::max(0, static_cast<int>(std::ceil(center.y - extent.y - 0.5f)));
+	quad.MaxX = std::min(static_cast<int>(this->Width), static_cast<int>(std::ceil(center.x + extent.x - 0.5f)));
+	quad.MaxY = std::min(static_cast<int>(this->Height), static_cast<int>(std::ceil(center.y + extent.y - 0.5f)));
+	if (quad.MinX < quad.MaxX && quad.MinY < quad.MaxY)
+		list.push_back(quad);
+}
+
+void SoftwareRenderer::rasterize(const std::vector<Quad>& list, unsigned int* target, int top, int bottom)
+{
+	unsigned int texels[SPAN_CHUNK];
+	for (const Quad& quad : list)
+	{
+		int minY = std::max(quad.MinY, top), maxY = std::min(quad.MaxY, bottom);
+		if (minY >= maxY)
+			continue;
+		const Image& image = *quad.Texture;
+		int tint[4] = { tintComponent(quad.Color.b), tintComponent(quad.Color.g), tintComponent(quad.Color.r), tintComponent(quad.Color.a) };
+		// texels per pixel
+		float stepU = image.Width / quad.Size.x, stepV = image.Height / quad.Size.y;
+		float radians = glm::radians(quad.Rotation);
+		float c = std::cos(radians), s = std::sin(radians);
+		glm::vec2 center = quad.Position + quad.Size * 0.5f;
+		for (int y = minY; y < maxY; ++y)
+		{
+			unsigned int* row = target + y * this->Width;
+			for (int x = quad.MinX; x < quad.MaxX; x += SPAN_CHUNK)
+			{
+				int count = std::min(SPAN_CHUNK, quad.MaxX - x);
+				if (quad.Rotation == 0.0f)
+				{
+					// axis aligned: one texture row, u advances in 16.16 fixed point
+					int v = std::min(static_cast<int>(image.Height) - 1, std::max(0, static_cast<int>((y + 0.5f - quad.Position.y) * stepV)));
+					const unsigned int* source = &image.Pixels[v * image.Width];
+					int u = static_cast<int>((x + 0.5f - quad.Position.x) * stepU * 65536.0f);
+					int du = static_cast<int>(stepU * 65536.0f);
+					int maxU = image.Width - 1;
+					for (int i = 0; i < count; ++i, u += du)
+						texels[i] = source[std::min(maxU, std::max(0, u >> 16))];
+				}
+				else
+				{
+					// rotated: map every pixel center back into the quad, pixels outside stay transparent
+					for (int i = 0; i < count; ++i)
+					{
+						float dx = x + i + 0.5f - center.x, dy = y + 0.5f - center.y;
+						float localX = dx * c + dy * s + quad.Size.x * 0.5f;
+						float localY = -dx * s + dy * c + quad.Size.y * 0.5f;
+						int u = static_cast<int>(std::floor(localX * stepU)), v = static_cast<int>(std::floor(localY * stepV));
+						bool inside = u >= 0 && v >= 0 && u < static_cast<int>(image.Width) && v < static_cast<int>(image.Height);
+						texels[i] = inside ? image.Pixels[v * image.Width + u] : 0;
+					}
+				}
+				blendSpan(row + x, texels, count, tint, quad.Blend);
+			}
+		}
+	}
+}
+
+void SoftwareRenderer::applyEffects(const EffectFlags& effects, float time, int top, int bottom)
+{
+	static const int EDGE_KERNEL[9] = { -1, -1, -1, -1, 8, -1, -1, -1, -1 };
+	static const int BLUR_KERNEL[9] = { 1, 2, 1, 2, 4, 2, 1, 2, 1 };
+	int width = this->Width, height = this->Height;
+	// the kernels sample 1/300th of the texture away, like PostProcessor::configureShader
+	int offsetX = std::max(1, static_cast<int>(width / 300.0f + 0.5f));
+	int offsetY = std::max(1, static_cast<int>(height / 300.0f + 0.5f));
+	// the shake moves the whole quad (in pixels, y down)
+	int shakeX = 0, shakeY = 0;
+	if (effects.Shake)
+	{
+		shakeX = static_cast<int>(std::round(std::cos(time * 10.0f) * 0.005f * width));
+		shakeY = -static_cast<int>(std::round(std::cos(time * 15.0f) * 0.005f * height));
+	}
+	// chaos swirls the texture coordinates around (texture v points up)
+	int chaosX = 0, chaosY = 0;
+	if (effects.Chaos)
+	{
+		chaosX = static_cast<int>(std::round(std::sin(time) * 0.3f * width));
+		chaosY = -static_cast<int>(std::round(std::cos(time) * 0.3f * height));
+	}
+	for (int y = top; y < bottom; ++y)
+	{
+		unsigned int* row = &this->Pixels[y * width];
+		int sourceY = y - shakeY;
+		// the shaken quad leaves a strip uncovered
+		int first = std::max(0, shakeX), last = std::min(width, width + shakeX);
+		if (sourceY < 0 || sourceY >= height)
+			first = last = width;
+		std::fill(row, row + first, CLEAR_COLOR);
+		std::fill(row + std::max(first, last), row + width, CLEAR_COLOR);
+		if (first >= last)
+			continue;
+		// same precedence as post_processing.frag: chaos, then confuse, then shake
+		if (effects.Confuse && !effects.Chaos)
+		{
+			const unsigned int* source = &this->scene[(height - 1 - sourceY) * width + (width - 1)];
+			for (int x = first; x < last; ++x)
+				row[x] = (~source[-(x - shakeX)] & 0xFFFFFF) | CLEAR_COLOR;
+			continue;
+		}
+		const int* kernel = effects.Chaos ? EDGE_KERNEL : BLUR_KERNEL;
+		int shift = effects.Chaos ? 0 : 4;
+		// taps wrap around the edges (the scene texture repeats)
+		int centerY = wrap(sourceY + chaosY, height);
+		const unsigned int* rows[3] = {
+			&this->scene[wrap(centerY - offsetY, height) * width],
+			&this->scene[centerY * width],
+			&this->scene[wrap(centerY + offsetY, height) * width]
+		};
+		int center = wrap(first - shakeX + chaosX, width);
+		for (int x = first; x < last; ++x, center = center + 1 < width ? center + 1 : 0)
+		{
+			int left = center - offsetX, right = center + offsetX;
+			if (left < 0 || right >= width)
+			{
+				left = wrap(left, width);
+				right = wrap(right, width);
+			}
+			row[x] = convolve(rows, left, center, right, kernel, shift);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "renderer.h"
+#include "resource_manager.h"
+#include "thread_pool.h"
+
+
+// Coverage bitmap of a glyph, stored as white pixels with the coverage as alpha
+struct SoftwareGlyph {
+	Image Bitmap;
+	glm::vec2 Bearing;
+	unsigned int Advance; // in 1/64 pixels
+};
+
+// SoftwareRenderer draws frame snapshots without any GPU: the textured, tinted
+// quads of the scene, the confuse/chaos/shake effects of post_processing.frag
+// and the text. The framebuffer is split into horizontal bands rasterized in
+// parallel on a thread pool; every band walks the sorted commands in order,
+// so the result matches the draw order of the GL path without any locking.
+// Spans are blended four pixels at a time with SSE2 (scalar elsewhere).
+// Init turns ResourceManager::UploadTextures off, textures are sampled from memory.
+class SoftwareRenderer : public Renderer
+{
+public:
+	// final image, 0xAARRGGBB rows top to bottom (the layout of a 32-bit top-down DIB)
+	std::vector<unsigned int> Pixels;
+	unsigned int Width, Height;
+	// constructor; the bands are rasterized on the given pool
+	SoftwareRenderer(ThreadPool& pool);
+	void Init(unsigned int width, unsigned int height) override;
+	// loads the glyphs of the first 128 ASCII characters
+	void LoadFont(std::string font, unsigned int fontSize) override;
+	// draws a snapshot into Pixels
+	void Render(const FrameSnapshot& snapshot) override;
+	// reallocates the framebuffer; the scene is stretched to the new size like the GL viewport
+	void Resize(unsigned int width, unsigned int height) override;
+	// writes Pixels to a PNG file
+	bool SaveFrame(const std::string& file) const;
+private:
+	ThreadPool& pool;
+	// size of the coordinate space the snapshot commands use
+	unsigned int sceneWidth, sceneHeight;
+	// scene target, only used when an effect is active
+	std::vector<unsigned int> scene;
+	std::map<char, SoftwareGlyph> glyphs;
+	// a quad resolved for rasterization
+	struct Quad {
+		const Image* Texture;
+		glm::vec2 Position, Size;
+		float Rotation;
+		glm::vec4 Color;
+		BlendMode Blend;
+		int MinX, MinY, MaxX, MaxY; // covered pixels, max exclusive
+	};
+	std::vector<Quad> quads, texts;
+	void addQuad(std::vector<Quad>& list, const Image* texture, glm::vec2 position, glm::vec2 size, float rotation, glm::vec4 color, BlendMode blend);
+	// draws the quads overlapping rows [top, bottom) of the target
+	void rasterize(const std::vector<Quad>& list, unsigned int* target, int top, int bottom);
+	// runs the post-processing effects for rows [top, bottom) from scene into Pixels
+	void applyEffects(const EffectFlags& effects, float time, int top, int bottom);
+};
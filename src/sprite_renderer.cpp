@@ -1,4 +1,5 @@
 #include "sprite_renderer.h"
+#include "render_stats.h"
 
 SpriteRenderer::SpriteRenderer(Shader& shader)
 {
@@ -31,6 +32,7 @@ void SpriteRenderer::DrawSprite(Texture2D& texture, glm::vec2 position, glm::vec
 
 	glBindVertexArray(this->quadVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
+	RenderStats::Current.Draw(6);
 	glBindVertexArray(0);
 }
 
@@ -0,0 +1,94 @@
+#include "stream_buffer.h"
+#include "render_stats.h"
+
+#include <cstring>
+#include <iostream>
+
+StreamBuffer::StreamBuffer(unsigned int size)
+	: Size(size), head(0), regionStart(0)
+{
+	glGenBuffers(1, &this->ID);
+	glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+	glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (Region& region : this->inFlight)
+		glDeleteSync(region.Fence);
+	glDeleteBuffers(1, &this->ID);
+}
+
+bool StreamBuffer::Upload(const void* data, unsigned int size, unsigned int& offset, unsigned int alignment)
+{
+	if (size > this->Size)
+	{
+		std::cout << "ERROR::STREAMBUFFER: Upload of " << size << " bytes exceeds the ring size of " << this->Size << std::endl;
+		return false;
+	}
+	offset = (this->head + alignment - 1) / alignment * alignment;
+	if (offset + size > this->Size)
+	{
+		// wrap around; fence what was written so far so every region stays contiguous
+		this->fenceRegion();
+		offset = 0;
+		this->regionStart = 0;
+	}
+	this->waitForRange(offset, offset + size);
+	++RenderStats::Current.BufferUploads;
+	RenderStats::Current.BufferBytes += size;
+
+	glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+	void* target = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+	if (target)
+	{
+		std::memcpy(target, data, size);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	this->head = offset + size;
+	return true;
+}
+
+void StreamBuffer::EndFrame()
+{
+	this->fenceRegion();
+	this->regionStart = this->head;
+	// drop regions the GPU already finished without waiting
+	while (!this->inFlight.empty() && glClientWaitSync(this->inFlight.front().Fence, 0, 0) != GL_TIMEOUT_EXPIRED)
+	{
+		glDeleteSync(this->inFlight.front().Fence);
+		this->inFlight.pop_front();
+	}
+}
+
+void StreamBuffer::waitForRange(unsigned int start, unsigned int end)
+{
+	// fences signal in order, so waiting on the newest overlapping region covers all older ones
+	int newest = -1;
+	for (unsigned int i = 0; i < this->inFlight.size(); ++i)
+	{
+		const Region& region = this->inFlight[i];
+		if (region.Start < end && start < region.End)
+			newest = i;
+	}
+	if (newest < 0)
+		return;
+	GLenum result = glClientWaitSync(this->inFlight[newest].Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); // 1 second
+	if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+		std::cout << "ERROR::STREAMBUFFER: Timed out waiting for the GPU to release the ring" << std::endl;
+	for (int i = 0; i <= newest; ++i)
+	{
+		glDeleteSync(this->inFlight.front().Fence);
+		this->inFlight.pop_front();
+	}
+}
+
+void StreamBuffer::fenceRegion()
+{
+	if (this->head <= this->regionStart)
+		return;
+	Region region = { glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), this->regionStart, this->head };
+	this->inFlight.push_back(region);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <deque>
+
+#include <glad/glad.h>
+
+
+// StreamBuffer sub-allocates per-frame vertex data from one large ring
+// buffer. Every upload is written through an unsynchronized mapping so it
+// never waits for the driver; instead each frame's region is guarded by a
+// fence, and a region is only written again once the GPU is done with it.
+class StreamBuffer
+{
+public:
+	// buffer object and its size in bytes
+	unsigned int ID;
+	unsigned int Size;
+	// constructor
+	StreamBuffer(unsigned int size);
+	~StreamBuffer();
+	// copies data into the ring and sets offset to its byte offset in the buffer; false (nothing
+	// copied) if it's larger than the ring, callers split such data into uploads of at most Size bytes
+	bool Upload(const void* data, unsigned int size, unsigned int& offset, unsigned int alignment = 16);
+	// fences everything uploaded since the previous call; call once per frame after the draws
+	void EndFrame();
+private:
+	// a fenced, contiguous region of the ring still in use by the GPU
+	struct Region {
+		GLsync Fence;
+		unsigned int Start, End;
+	};
+	std::deque<Region> inFlight;
+	// next free byte and start of the region not fenced yet
+	unsigned int head, regionStart;
+	// waits until the GPU no longer reads any byte of [start, end)
+	void waitForRange(unsigned int start, unsigned int end);
+	// fences [regionStart, head)
+	void fenceRegion();
+};
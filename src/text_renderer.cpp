@@ -7,20 +7,21 @@
 
 #include "text_renderer.h"
 #include "resource_manager.h"
+#include "render_stats.h"
+#include "asset_pack.h"
 
 
-TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+TextRenderer::TextRenderer(unsigned int width, unsigned int height, StreamBuffer* stream)
+	: projection(glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f)), stream(stream)
 {
 	// load and configure shader
 	this->TextShader = ResourceManager::LoadShader("shaders/text_2d.vs", "shaders/text_2d.frag", nullptr, "text");
-	this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
+	this->TextShader.SetMatrix4("projection", this->projection, true);
 	this->TextShader.SetInteger("text", 0);
-	// configure VAO/VBO for texture quads
+	// configure VAO for texture quads, sourced from the stream buffer (draws select the quads by first vertex)
 	glGenVertexArrays(1, &this->VAO);
-	glGenBuffers(1, &this->VBO);
 	glBindVertexArray(this->VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, this->stream->ID);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -35,9 +36,10 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
 	FT_Library ft;
 	if (FT_Init_FreeType(&ft)) // all functions return a value different than 0 whenever an error occurred
 		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-	// load font as face
+	// load font as face, read in place (the data only has to outlive the face)
+	Asset fontFile;
 	FT_Face face;
-	if (FT_New_Face(ft, font.c_str(), 0, &face))
+	if (!fontFile.Open(font) || FT_New_Memory_Face(ft, fontFile.Data, static_cast<FT_Long>(fontFile.Size), 0, &face))
 		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
 	// set size to load glyphs as
 	FT_Set_Pixel_Sizes(face, 0, fontSize);
@@ -90,13 +92,10 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
 
 void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
 {
-	// activate corresponding render state
-	this->TextShader.Use();
-	this->TextShader.SetVector3f("textColor", color);
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(this->VAO);
-
-	// iterate through all character
+	if (text.empty())
+		return;
+	// build the quads of all glyphs and upload them at once
+	this->vertices.clear();
 	std::string::const_iterator c;
 	for (c = text.begin(); c != text.end(); c++)
 	{
@@ -107,8 +106,7 @@ void TextRenderer::RenderText(std::string text, float x, float y, float scale, g
 
 		float w = ch.Size.x * scale;
 		float h = ch.Size.y * scale;
-		// update VBO for each character
-		float vertices[6][4] = {
+		float quad[6][4] = {
 			{xpos, 		ypos + h, 	0.0f, 1.0f},
 			{xpos + w,  ypos, 		1.0f, 0.0f},
 			{xpos, 		ypos, 		0.0f, 0.0f},
@@ -116,17 +114,38 @@ void TextRenderer::RenderText(std::string text, float x, float y, float scale, g
 			{xpos + w,  ypos + h, 	1.0f, 1.0f},
 			{xpos + w,  ypos, 		1.0f, 0.0f}
 		};
-		// render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-		// update content of VBO memory
-		glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		// render quad
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		this->vertices.insert(this->vertices.end(), &quad[0][0], &quad[0][0] + 6 * 4);
 		// now advance cursors for next glyph
 		x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1 / 64th times 2^6 = 256)
 	}
+	const unsigned int stride = 4 * sizeof(float);
+	unsigned int first;
+	if (!this->stream->Upload(this->vertices.data(), this->vertices.size() * sizeof(float), first, stride))
+		return;
+	first /= stride;
+
+	// activate corresponding render state
+	this->TextShader.Use();
+	this->TextShader.SetVector3f("textColor", color);
+	glActiveTexture(GL_TEXTURE0);
+	glBindVertexArray(this->VAO);
+	for (unsigned int i = 0; i < text.size(); ++i)
+	{
+		// render glyph texture over quad
+		glBindTexture(GL_TEXTURE_2D, Characters[text[i]].TextureID);
+		glDrawArrays(GL_TRIANGLES, first + i * 6, 6);
+		++RenderStats::Current.TextureBinds;
+		RenderStats::Current.Draw(6);
+	}
 	glBindVertexArray(0);
 	glBindTexture(GL_TEXTURE_2D, 0);
-}
\ No newline at end of file
+}
+
+void TextRenderer::ReplaceShader(unsigned int previous, const Shader& shader)
+{
+	if (this->TextShader.ID != previous)
+		return;
+	this->TextShader = shader;
+	this->TextShader.SetMatrix4("projection", this->projection, true);
+	this->TextShader.SetInteger("text", 0);
+}
@@ -2,12 +2,14 @@
 
 
 #include <map>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "texture.h"
 #include "shader.h"
+#include "stream_buffer.h"
 
 
 // Holds all state information relevant to a character as loaded using FreeType
@@ -26,13 +28,19 @@ public:
 	std::map<char, Character> Characters;
 	// shader used for text rendering
 	Shader TextShader;
-	// constructor
-	TextRenderer(unsigned int width, unsigned int height);
+	// constructor; glyph quads are streamed through the given ring
+	TextRenderer(unsigned int width, unsigned int height, StreamBuffer* stream);
 	// pre-compiles a list of characters from the given font
 	void Load(std::string font, unsigned int fontSize);
 	// renders a string of text using the precompiled list of characters
 	void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+	// draws with a rebuilt shader if it replaces the text shader
+	void ReplaceShader(unsigned int previous, const Shader& shader);
 private:
+	glm::mat4 projection;
 	// render state
-	unsigned int VAO, VBO;
+	StreamBuffer* stream;
+	unsigned int VAO;
+	// glyph quads of the string being rendered
+	std::vector<float> vertices;
 };
\ No newline at end of file
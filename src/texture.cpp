@@ -1,16 +1,19 @@
 #include "texture.h"
+#include "render_stats.h"
 
 Texture2D::Texture2D()
-	:Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB),
+	:ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB),
 	Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
 {
-	glGenTextures(1, &this->ID);
+	// the GL texture is created on the first Generate, so textures can exist without a context
 }
 
-void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
+void Texture2D::Generate(unsigned int width, unsigned int height, const unsigned char* data)
 {
 	this->Width = width;
 	this->Height = height;
+	if (this->ID == 0)
+		glGenTextures(1, &this->ID);
 	glBindTexture(GL_TEXTURE_2D, this->ID);
 	glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
 	// set texture wrap and filter modes
@@ -22,7 +25,16 @@ void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char*
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void Texture2D::GenerateLevel(unsigned int level, unsigned int width, unsigned int height, const unsigned char* data)
+{
+	glBindTexture(GL_TEXTURE_2D, this->ID);
+	glTexImage2D(GL_TEXTURE_2D, level, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void Texture2D::Bind() const
 {
 	glBindTexture(GL_TEXTURE_2D, this->ID);
+	++RenderStats::Current.TextureBinds;
 }
\ No newline at end of file
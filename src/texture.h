@@ -16,7 +16,9 @@ public:
 	unsigned int Filter_Max;
 
 	Texture2D();
-	void Generate(unsigned int width, unsigned int height, unsigned char* data);
+	void Generate(unsigned int width, unsigned int height, const unsigned char* data);
+	// uploads a smaller mip level; level 0 has to be created with Generate first
+	void GenerateLevel(unsigned int level, unsigned int width, unsigned int height, const unsigned char* data);
 	void Bind() const;
 
 };
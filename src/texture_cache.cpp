@@ -0,0 +1,149 @@
+#include "texture_cache.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "stb_image.h"
+#include "asset_pack.h"
+#include "hash.h"
+
+const unsigned int BAKED_VERSION = 1;
+
+std::string TextureCache::Directory = "cache/textures";
+std::atomic<unsigned int> TextureCache::Hits(0);
+std::atomic<unsigned int> TextureCache::Bakes(0);
+
+// bytes of a whole mip chain
+size_t chainSize(unsigned int width, unsigned int height, unsigned int channels, unsigned int levels)
+{
+	size_t size = 0;
+	for (unsigned int level = 0; level < levels; ++level)
+	{
+		size += static_cast<size_t>(width) * height * channels;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return size;
+}
+
+BakedTexture::BakedTexture()
+	: Width(0), Height(0), Channels(0), Levels(0), pixels(nullptr)
+{
+
+}
+
+const unsigned char* BakedTexture::Level(unsigned int level, unsigned int& width, unsigned int& height) const
+{
+	width = this->Width;
+	height = this->Height;
+	const unsigned char* data = this->pixels;
+	for (unsigned int i = 0; i < level; ++i)
+	{
+		data += static_cast<size_t>(width) * height * this->Channels;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	return data;
+}
+
+bool BakedTexture::attach(const unsigned char* data, size_t size, unsigned long long sourceHash, unsigned int channels)
+{
+	if (size < sizeof(BakedHeader))
+		return false;
+	BakedHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.Magic, "BTEX", 4) != 0 || header.Version != BAKED_VERSION || header.SourceHash != sourceHash ||
+		header.Channels != channels || header.Levels == 0 || header.Levels > 32 ||
+		size != sizeof(BakedHeader) + chainSize(header.Width, header.Height, header.Channels, header.Levels))
+		return false;
+	this->Width = header.Width;
+	this->Height = header.Height;
+	this->Channels = header.Channels;
+	this->Levels = header.Levels;
+	this->pixels = data + sizeof(BakedHeader);
+	return true;
+}
+
+BakedTexture* TextureCache::Load(const std::string& file, int channels)
+{
+	// the source is always read, its hash tells whether the baked copy is still current
+	// (in place, from the asset pack or the mapped file)
+	Asset source;
+	if (!source.Open(file))
+	{
+		std::cout << "ERROR::TEXTURE: Failed to open image: " << file << std::endl;
+		return nullptr;
+	}
+	unsigned long long sourceHash = HashBytes(source.Data, source.Size);
+	std::string cacheFile = Directory + "/" + HashHex(HashString(file + ":" + std::to_string(channels))) + ".btex";
+
+	BakedTexture* texture = new BakedTexture();
+	if (texture->file.Open(cacheFile) && texture->attach(texture->file.Data, texture->file.Size, sourceHash, channels))
+	{
+		++Hits;
+		return texture;
+	}
+	texture->file.Close();
+	if (!bake(source.Data, source.Size, sourceHash, channels, cacheFile, texture->memory))
+	{
+		delete texture;
+		return nullptr;
+	}
+	++Bakes;
+	texture->attach(texture->memory.data(), texture->memory.size(), sourceHash, channels);
+	return texture;
+}
+
+bool TextureCache::bake(const unsigned char* source, size_t sourceSize, unsigned long long sourceHash, int channels, const std::string& cacheFile, std::vector<unsigned char>& container)
+{
+	int width, height, nrChannels;
+	unsigned char* data = stbi_load_from_memory(source, static_cast<int>(sourceSize), &width, &height, &nrChannels, channels);
+	if (!data)
+	{
+		std::cout << "ERROR::TEXTURE: Failed to decode image for " << cacheFile << std::endl;
+		return false;
+	}
+	// levels down to 1x1
+	unsigned int levels = 1;
+	for (unsigned int size = width > height ? width : height; size > 1; size /= 2)
+		++levels;
+	BakedHeader header = { { 'B', 'T', 'E', 'X' }, BAKED_VERSION, sourceHash,
+		static_cast<unsigned int>(width), static_cast<unsigned int>(height), static_cast<unsigned int>(channels), levels };
+	container.resize(sizeof(BakedHeader) + chainSize(width, height, channels, levels));
+	std::memcpy(container.data(), &header, sizeof(header));
+	unsigned char* level = container.data() + sizeof(BakedHeader);
+	std::memcpy(level, data, static_cast<size_t>(width) * height * channels);
+	stbi_image_free(data);
+
+	// every level averages 2x2 texels of the one above (edges of odd sizes are clamped)
+	unsigned int levelWidth = width, levelHeight = height;
+	for (unsigned int i = 1; i < levels; ++i)
+	{
+		unsigned int nextWidth = levelWidth > 1 ? levelWidth / 2 : 1;
+		unsigned int nextHeight = levelHeight > 1 ? levelHeight / 2 : 1;
+		unsigned char* next = level + static_cast<size_t>(levelWidth) * levelHeight * channels;
+		for (unsigned int y = 0; y < nextHeight; ++y)
+		{
+			unsigned int y0 = y * 2, y1 = y * 2 + 1 < levelHeight ? y * 2 + 1 : y * 2;
+			for (unsigned int x = 0; x < nextWidth; ++x)
+			{
+				unsigned int x0 = x * 2, x1 = x * 2 + 1 < levelWidth ? x * 2 + 1 : x * 2;
+				for (int c = 0; c < channels; ++c)
+				{
+					unsigned int sum = level[(y0 * levelWidth + x0) * channels + c] + level[(y0 * levelWidth + x1) * channels + c] +
+						level[(y1 * levelWidth + x0) * channels + c] + level[(y1 * levelWidth + x1) * channels + c];
+					next[(y * nextWidth + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+		level = next;
+		levelWidth = nextWidth;
+		levelHeight = nextHeight;
+	}
+
+	// a failed write only costs baking again next time
+	MakeDirectories(Directory);
+	if (!WriteFileReplacing(cacheFile, container.data(), container.size()))
+		std::cout << "ERROR::TEXTURE: Failed to write texture cache: " << cacheFile << std::endl;
+	return true;
+}
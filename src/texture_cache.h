@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+
+// Header of a baked texture (.btex); the mip levels follow it, largest
+// first, each one's rows tightly packed from top to bottom
+struct BakedHeader {
+	char Magic[4];                 // "BTEX"
+	unsigned int Version;
+	unsigned long long SourceHash; // hash of the source file's bytes
+	unsigned int Width, Height, Channels, Levels;
+};
+
+// The mip chain of a texture, ready to be uploaded as is. The pixels point
+// into the mapped cache file (or into memory if it couldn't be written).
+class BakedTexture
+{
+public:
+	unsigned int Width, Height, Channels, Levels;
+	BakedTexture();
+	// pixels and size of a mip level
+	const unsigned char* Level(unsigned int level, unsigned int& width, unsigned int& height) const;
+private:
+	friend class TextureCache;
+	MappedFile file;
+	std::vector<unsigned char> memory;
+	const unsigned char* pixels; // level 0, the others follow it
+	// points the texture at a container, false if it isn't a valid one
+	bool attach(const unsigned char* data, size_t size, unsigned long long sourceHash, unsigned int channels);
+};
+
+// TextureCache turns image files into baked textures: decoded, converted to
+// the requested channel count, with a full box-filtered mip chain. Each
+// source file has one cache file that records the hash of the source it was
+// baked from; if the source changes it is baked again, otherwise loading
+// only hashes the source and maps the cache file, nothing is decoded. Safe
+// to call from several threads for different files.
+class TextureCache
+{
+public:
+	// where the baked files are kept
+	static std::string Directory;
+	// loads done from the cache and loads that had to bake
+	static std::atomic<unsigned int> Hits, Bakes;
+	// returns the baked texture of an image file; nullptr if the file can't be read or decoded
+	static BakedTexture* Load(const std::string& file, int channels);
+private:
+	TextureCache() { }
+	// decodes an image and writes its container; the result is left in memory
+	static bool bake(const unsigned char* source, size_t sourceSize, unsigned long long sourceHash, int channels, const std::string& cacheFile, std::vector<unsigned char>& container);
+};
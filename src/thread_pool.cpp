@@ -0,0 +1,98 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+
+ThreadPool::ThreadPool(unsigned int workers)
+	: stopping(false)
+{
+	if (workers == 0)
+	{
+		unsigned int hardware = std::thread::hardware_concurrency();
+		workers = hardware > 1 ? hardware - 1 : 1;
+	}
+	for (unsigned int i = 0; i < workers; ++i)
+		this->workers.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	for (std::thread& worker : this->workers)
+		worker.join();
+}
+
+unsigned int ThreadPool::Threads() const
+{
+	return static_cast<unsigned int>(this->workers.size()) + 1;
+}
+
+void ThreadPool::Enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->jobs.push_back(std::move(job));
+	}
+	this->wake.notify_one();
+}
+
+// bookkeeping of a ParallelFor, shared with the helper jobs since they may only get to run after it returned
+struct ParallelState {
+	std::atomic<unsigned int> Next;
+	std::atomic<unsigned int> Finished;
+	std::mutex Mutex;
+	std::condition_variable Done;
+	ParallelState() : Next(0), Finished(0) { }
+};
+
+void ThreadPool::ParallelFor(unsigned int count, const std::function<void(unsigned int)>& job)
+{
+	if (count == 0)
+		return;
+	// indices are claimed from a shared counter, so fast threads take over the work of slow ones
+	std::shared_ptr<ParallelState> state = std::make_shared<ParallelState>();
+	const std::function<void(unsigned int)>* body = &job;
+	auto worker = [state, body, count]() {
+		unsigned int claimed = 0;
+		// late helpers find every index claimed and never touch the (by then gone) job
+		for (unsigned int i = state->Next++; i < count; i = state->Next++)
+		{
+			(*body)(i);
+			++claimed;
+		}
+		if (claimed > 0 && (state->Finished += claimed) == count)
+		{
+			std::lock_guard<std::mutex> lock(state->Mutex);
+			state->Done.notify_one();
+		}
+	};
+	unsigned int helpers = std::min(count, this->Threads()) - 1;
+	for (unsigned int i = 0; i < helpers; ++i)
+		this->Enqueue(worker);
+	worker();
+	std::unique_lock<std::mutex> lock(state->Mutex);
+	state->Done.wait(lock, [&]() { return state->Finished == count; });
+}
+
+void ThreadPool::run()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->wake.wait(lock, [this]() { return this->stopping || !this->jobs.empty(); });
+			if (this->stopping && this->jobs.empty())
+				return;
+			job = std::move(this->jobs.front());
+			this->jobs.pop_front();
+		}
+		job();
+	}
+}
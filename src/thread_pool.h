@@ -0,0 +1,32 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// A fixed set of worker threads running queued jobs. ParallelFor splits work
+// into indexed jobs and lets the calling thread help until all are done.
+class ThreadPool
+{
+public:
+	// constructor; 0 workers picks one less than the number of hardware threads (the caller is the last one)
+	ThreadPool(unsigned int workers = 0);
+	~ThreadPool();
+	// number of threads working on a ParallelFor, including the caller
+	unsigned int Threads() const;
+	// queues a job to be run by any worker
+	void Enqueue(std::function<void()> job);
+	// runs job(0) ... job(count - 1) spread over the workers and returns once all of them finished
+	void ParallelFor(unsigned int count, const std::function<void(unsigned int)>& job);
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping;
+	void run();
+};